@@ -0,0 +1,74 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { JsonRpcProvider } from '@ethersproject/providers'
+
+import { Inbox__factory } from '../src/lib/abi/factories/Inbox__factory'
+import { L1GatewayRouter__factory } from '../src/lib/abi/factories/L1GatewayRouter__factory'
+import {
+  connectContract,
+  createContract,
+  getInterface,
+} from '../src/lib/utils/contractCache'
+
+import args from './getCLargs'
+
+// compares creating typechain interfaces and contracts on every call, as the
+// sdk used to, with the cached interfaces and pooled contracts
+
+const iterations = args.iterations || 10000
+// never connected, contracts are only constructed
+const provider = new JsonRpcProvider('http://localhost:8545')
+const address = '0x0000000000000000000000000000000000000001'
+
+const measure = (name: string, run: () => unknown) => {
+  global.gc?.()
+  const heapBefore = process.memoryUsage().heapUsed
+  const start = process.hrtime.bigint()
+  for (let i = 0; i < iterations; i++) run()
+  const ms = Number(process.hrtime.bigint() - start) / 1e6
+  const heapKb = (process.memoryUsage().heapUsed - heapBefore) / 1024
+  console.log(
+    `${name}: ${ms.toFixed(1)}ms, ${((ms * 1000) / iterations).toFixed(
+      2
+    )}us per call, heap +${heapKb.toFixed(0)}KB`
+  )
+}
+
+const main = () => {
+  console.log(`${iterations} iterations`)
+  measure('createInterface', () => Inbox__factory.createInterface())
+  measure('getInterface', () => getInterface(Inbox__factory))
+  measure('factory.connect', () =>
+    L1GatewayRouter__factory.connect(address, provider)
+  )
+  measure('createContract', () =>
+    createContract(L1GatewayRouter__factory, address, provider)
+  )
+  measure('connectContract', () =>
+    connectContract(L1GatewayRouter__factory, address, provider)
+  )
+}
+
+try {
+  main()
+  process.exit(0)
+} catch (error) {
+  console.error(error)
+  process.exit(1)
+}
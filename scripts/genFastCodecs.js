@@ -0,0 +1,500 @@
+const { glob } = require('typechain')
+const { readFileSync, writeFileSync } = require('fs')
+const { Interface } = require('@ethersproject/abi')
+const prettier = require('prettier')
+
+// Generates src/lib/abi/fastCodecs.ts, which holds encoders and decoders specialised
+// to a few of the functions and events the sdk encodes and decodes the most. Each
+// codec is straight line code over the hex data, using the helpers in
+// src/lib/utils/fastAbi.ts, instead of a walk over generic ethers coders. Integers
+// of at most 48 bits are decoded to numbers and larger ones to bigints, rather than
+// to BigNumbers.
+//
+// Functions get an encoder for their calldata and a decoder for their result,
+// events get a decoder for their logs.
+const CODECS = [
+  {
+    contract: 'Multicall2',
+    function: 'tryAggregate(bool,(address,bytes)[])',
+    name: 'TryAggregate',
+  },
+  {
+    contract: 'L1GatewayRouter',
+    function: 'outboundTransfer(address,address,uint256,uint256,uint256,bytes)',
+    name: 'L1OutboundTransfer',
+  },
+  {
+    contract: 'L2GatewayRouter',
+    function: 'outboundTransfer(address,address,uint256,bytes)',
+    name: 'L2OutboundTransfer',
+  },
+  { contract: 'ArbSys', event: 'L2ToL1Tx', name: 'L2ToL1Tx' },
+  { contract: 'Bridge', event: 'MessageDelivered', name: 'MessageDelivered' },
+  {
+    contract: 'Inbox',
+    event: 'InboxMessageDelivered(uint256,bytes)',
+    name: 'InboxMessageDelivered',
+  },
+  {
+    contract: 'ArbRetryableTx',
+    event: 'RedeemScheduled',
+    name: 'RedeemScheduled',
+  },
+]
+
+const OUT_FILE = './src/lib/abi/fastCodecs.ts'
+
+// integers up to this size are decoded to numbers
+const MAX_NUMBER_BITS = 48
+
+const getPackagePath = packageName => {
+  const path = require.resolve(`${packageName}/package.json`)
+  return path.substr(0, path.indexOf('package.json'))
+}
+
+const toConstName = name =>
+  name.replace(/([a-z0-9])([A-Z])/g, '$1_$2').toUpperCase()
+
+const isDynamic = param => {
+  if (param.baseType === 'array') return true
+  if (param.baseType === 'tuple') return param.components.some(isDynamic)
+  return param.baseType === 'bytes' || param.baseType === 'string'
+}
+
+// size in bytes of a value in the head of a tuple
+const headSize = param =>
+  param.baseType === 'tuple' && !isDynamic(param)
+    ? param.components.reduce((size, c) => size + headSize(c), 0)
+    : 32
+
+const checkSupported = param => {
+  if (param.baseType === 'array' && param.arrayLength !== -1) {
+    throw new Error(`Fixed size arrays are not supported: ${param.format()}`)
+  }
+  if (param.baseType === 'tuple' && param.components.some(c => !c.name)) {
+    throw new Error(`Tuples need named components: ${param.format()}`)
+  }
+  if (
+    !['address', 'bool', 'bytes', 'array', 'tuple'].includes(param.baseType) &&
+    !/^uint\d+$/.test(param.baseType) &&
+    !/^bytes\d+$/.test(param.baseType)
+  ) {
+    throw new Error(`Type not supported: ${param.format()}`)
+  }
+}
+
+const uintBits = param => parseInt(param.baseType.slice(4), 10)
+
+// adds a number of hex characters to a position
+const offsetPos = (pos, length) =>
+  length === 0
+    ? pos
+    : typeof pos === 'number'
+    ? pos + length
+    : `${pos} + ${length}`
+
+class CodecWriter {
+  constructor() {
+    this.helpers = []
+    this.helperNames = new Map()
+    this.imports = new Set()
+  }
+
+  use(name) {
+    this.imports.add(name)
+    return name
+  }
+
+  tsType(param, input) {
+    checkSupported(param)
+    switch (param.baseType) {
+      case 'address':
+        return 'string'
+      case 'bool':
+        return 'boolean'
+      case 'array':
+        return `Array<${this.tsType(param.arrayChildren, input)}>`
+      case 'tuple':
+        return `{ ${param.components
+          .map(c => `${c.name}: ${this.tsType(c, input)}`)
+          .join('; ')} }`
+      default:
+        if (param.baseType.startsWith('uint')) {
+          if (input) return this.use('UintLike')
+          return uintBits(param) <= MAX_NUMBER_BITS ? 'number' : 'bigint'
+        }
+        // bytes and bytesN
+        return input ? this.use('BytesLike') : 'string'
+    }
+  }
+
+  // reuses a helper function for each type, creating it if needed
+  helper(kind, param, create) {
+    const key = `${kind}:${param.format('full')}`
+    let name = this.helperNames.get(key)
+    if (!name) {
+      const body = create()
+      name = `${kind}${param.baseType === 'array' ? 'Array' : 'Tuple'}${
+        this.helperNames.size
+      }`
+      this.helperNames.set(key, name)
+      this.helpers.push(`const ${name} = ${body}`)
+    }
+    return name
+  }
+
+  // an expression decoding the value whose encoding starts at pos of data
+  decodeValue(param, pos, data = 'data') {
+    checkSupported(param)
+    switch (param.baseType) {
+      case 'address':
+        return `${this.use('decodeAddress')}(${data}, ${pos})`
+      case 'bool':
+        return `${this.use('decodeBool')}(${data}, ${pos})`
+      case 'bytes':
+        return `${this.use('decodeBytes')}(${data}, ${pos})`
+      case 'array':
+        return `${this.decodeArrayHelper(param)}(${data}, ${pos})`
+      case 'tuple':
+        return `${this.decodeTupleHelper(param)}(${data}, ${pos})`
+      default: {
+        if (param.baseType.startsWith('bytes')) {
+          const size = param.baseType.slice(5)
+          return `${this.use('decodeFixedBytes')}(${data}, ${pos}, ${size})`
+        }
+        const bits = uintBits(param)
+        return bits <= MAX_NUMBER_BITS
+          ? `${this.use('decodeNumber')}(${data}, ${pos}, ${bits})`
+          : `${this.use('decodeBigInt')}(${data}, ${pos}, ${bits})`
+      }
+    }
+  }
+
+  // an expression decoding a value in the head of a tuple starting at start
+  decodeHead(param, start, headPos) {
+    const pos = offsetPos(start, headPos)
+    return isDynamic(param)
+      ? this.decodeValue(
+          param,
+          `${start} + ${this.use('decodeOffset')}(data, ${pos})`
+        )
+      : this.decodeValue(param, pos)
+  }
+
+  // object literal entries decoding the components of a tuple starting at start
+  decodeComponents(components, start) {
+    let headPos = 0
+    return components.map(c => {
+      const entry = `${c.name}: ${this.decodeHead(c, start, headPos)}`
+      headPos += headSize(c) * 2
+      return entry
+    })
+  }
+
+  decodeTupleHelper(param) {
+    return this.helper(
+      'decode',
+      param,
+      () =>
+        `(data: string, pos: number): ${this.tsType(param, false)} => ({
+          ${this.decodeComponents(param.components, 'pos').join(',\n')}
+        })`
+    )
+  }
+
+  decodeArrayHelper(param) {
+    const child = param.arrayChildren
+    return this.helper('decode', param, () => {
+      const elementLength = headSize(child) * 2
+      const element = isDynamic(child)
+        ? this.decodeValue(
+            child,
+            `start + ${this.use('decodeOffset')}(data, start + i * 64)`
+          )
+        : this.decodeValue(child, `start + i * ${elementLength}`)
+      const type = this.tsType(param, false)
+      return `(data: string, pos: number): ${type} => {
+        const length = ${this.use(
+          'decodeLength'
+        )}(data, pos, ${elementLength})
+        const start = pos + 64
+        const values: ${type} = new Array(length)
+        for (let i = 0; i < length; i++) {
+          values[i] = ${element}
+        }
+        return values
+      }`
+    })
+  }
+
+  // an expression encoding a value
+  encodeValue(param, value) {
+    checkSupported(param)
+    switch (param.baseType) {
+      case 'address':
+        return `${this.use('encodeAddress')}(${value})`
+      case 'bool':
+        return `${this.use('encodeBool')}(${value})`
+      case 'bytes':
+        return `${this.use('encodeBytes')}(${value})`
+      case 'array':
+        return `${this.encodeArrayHelper(param)}(${value})`
+      case 'tuple':
+        return `${this.encodeTupleHelper(param)}(${value})`
+      default:
+        if (param.baseType.startsWith('bytes')) {
+          const size = param.baseType.slice(5)
+          return `${this.use('encodeFixedBytes')}(${value}, ${size})`
+        }
+        return `${this.use('encodeUint')}(${value}, ${uintBits(param)})`
+    }
+  }
+
+  // statements and an expression encoding a tuple, given the component values
+  encodeComponents(components, values) {
+    const size = components.reduce((s, c) => s + headSize(c), 0)
+    const statements = []
+    const heads = []
+    const tails = []
+    components.forEach((c, i) => {
+      if (isDynamic(c)) {
+        const tail = `tail${i}`
+        statements.push(`const ${tail} = ${this.encodeValue(c, values[i])}`)
+        const offset = tails.length
+          ? `${size} + (${tails.map(t => `${t}.length`).join(' + ')}) / 2`
+          : `${size}`
+        heads.push(`${this.use('encodeUint')}(${offset}, 256)`)
+        tails.push(tail)
+      } else heads.push(this.encodeValue(c, values[i]))
+    })
+    return { statements, expression: [...heads, ...tails].join(' + ') }
+  }
+
+  encodeTupleHelper(param) {
+    return this.helper('encode', param, () => {
+      const { statements, expression } = this.encodeComponents(
+        param.components,
+        param.components.map(c => `value.${c.name}`)
+      )
+      return `(value: ${this.tsType(param, true)}): string => {
+        ${statements.join('\n')}
+        return ${expression}
+      }`
+    })
+  }
+
+  encodeArrayHelper(param) {
+    const child = param.arrayChildren
+    return this.helper('encode', param, () => {
+      const type = this.tsType(param, true)
+      const encodeLength = `${this.use('encodeUint')}(values.length, 256)`
+      if (!isDynamic(child)) {
+        return `(values: ${type}): string => {
+          let encoded = ${encodeLength}
+          for (const value of values) encoded += ${this.encodeValue(
+            child,
+            'value'
+          )}
+          return encoded
+        }`
+      }
+      return `(values: ${type}): string => {
+        let encoded = ${encodeLength}
+        let tails = ''
+        let offset = values.length * 32
+        for (const value of values) {
+          const tail = ${this.encodeValue(child, 'value')}
+          encoded += ${this.use('encodeUint')}(offset, 256)
+          tails += tail
+          offset += tail.length / 2
+        }
+        return encoded + tails
+      }`
+    })
+  }
+
+  writeFunction(iFace, spec) {
+    const fragment = iFace.getFunction(spec.function)
+    const constName = `${toConstName(spec.name)}_SELECTOR`
+    const args = fragment.inputs.map((p, i) => p.name || `arg${i}`)
+    const params = fragment.inputs.map(
+      (p, i) => `${args[i]}: ${this.tsType(p, true)}`
+    )
+    const { statements, expression } = this.encodeComponents(
+      fragment.inputs,
+      args
+    )
+    const out = [
+      `export const ${constName} = '${iFace.getSighash(fragment)}'`,
+      `/**
+       * Encode the calldata of ${fragment.format()} on ${spec.contract}
+       */
+      export const encode${spec.name} = (${params.join(', ')}): string => {
+        ${statements.join('\n')}
+        return ${constName} + ${expression}
+      }`,
+    ]
+
+    if (fragment.outputs.length > 0) {
+      const single = fragment.outputs.length === 1
+      if (!single && fragment.outputs.some(o => !o.name)) {
+        throw new Error(`Outputs need names: ${fragment.format()}`)
+      }
+      const type = single
+        ? this.tsType(fragment.outputs[0], false)
+        : `{ ${fragment.outputs
+            .map(o => `${o.name}: ${this.tsType(o, false)}`)
+            .join('; ')} }`
+      const result = single
+        ? this.decodeHead(fragment.outputs[0], 2, 0)
+        : `{ ${this.decodeComponents(fragment.outputs, 2).join(',\n')} }`
+      out.push(`/**
+        * Decode the result of ${fragment.format()} on ${spec.contract}
+        */
+        export const decode${spec.name}Result = (returnData: string): ${type} => {
+          const data = ${this.use('hexData')}(returnData)
+          return ${result}
+        }`)
+    }
+    return out
+  }
+
+  writeEvent(iFace, spec) {
+    const fragment = iFace.getEvent(spec.event)
+    if (fragment.anonymous) {
+      throw new Error(`Anonymous events are not supported: ${spec.event}`)
+    }
+    const constName = `${toConstName(spec.name)}_TOPIC`
+    const typeName = `${spec.name}EventArgs`
+    const indexed = fragment.inputs.filter(p => p.indexed)
+    const dataParams = fragment.inputs.filter(p => !p.indexed)
+    const dataEntries = this.decodeComponents(dataParams, 2)
+
+    const fields = []
+    const entries = fragment.inputs.map(p => {
+      if (!p.name) throw new Error(`Event args need names: ${spec.event}`)
+      if (!p.indexed) {
+        fields.push(`${p.name}: ${this.tsType(p, false)}`)
+        return dataEntries[dataParams.indexOf(p)]
+      }
+      const topic = `${this.use('hexData')}(log.topics[${
+        indexed.indexOf(p) + 1
+      }])`
+      // indexed dynamic values are only available as their hash
+      if (isDynamic(p)) {
+        fields.push(`${p.name}: string`)
+        return `${p.name}: ${topic}`
+      }
+      fields.push(`${p.name}: ${this.tsType(p, false)}`)
+      return `${p.name}: ${this.decodeValue(p, 2, topic)}`
+    })
+
+    return [
+      `export const ${constName} = '${iFace.getEventTopic(fragment)}'`,
+      `export type ${typeName} = { ${fields.join('; ')} }`,
+      `/**
+       * Decode a log of ${fragment.format()} on ${spec.contract}
+       */
+      export const decode${spec.name}Event = (log: {
+        topics: string[]
+        data: string
+      }): ${typeName} => {
+        ${this.use('checkTopics')}(log.topics, ${constName}, ${
+        indexed.length + 1
+      }, '${fragment.name}')
+        ${
+          dataParams.length > 0
+            ? `const data = ${this.use('hexData')}(log.data)`
+            : ''
+        }
+        return {
+          ${entries.join(',\n')}
+        }
+      }`,
+    ]
+  }
+
+  write(abis) {
+    const exports = []
+    for (const spec of CODECS) {
+      const iFace = findInterface(abis, spec)
+      exports.push(
+        ...(spec.function
+          ? this.writeFunction(iFace, spec)
+          : this.writeEvent(iFace, spec))
+      )
+    }
+    const helperImports = Array.from(this.imports).filter(
+      i => i !== 'BytesLike'
+    )
+    return [
+      '/* Autogenerated file. Do not edit manually. */',
+      '/* tslint:disable */',
+      '/* eslint-disable */',
+      this.imports.has('BytesLike')
+        ? "import { BytesLike } from '@ethersproject/bytes'"
+        : '',
+      `import { ${helperImports.sort().join(', ')} } from '../utils/fastAbi'`,
+      ...this.helpers,
+      ...exports,
+    ].join('\n\n')
+  }
+}
+
+// several packages can have contracts of the same name, so take the last one,
+// as typechain does, that has the function or event
+const findInterface = (abis, spec) => {
+  for (const abi of (abis.get(spec.contract) || []).slice().reverse()) {
+    const iFace = new Interface(abi)
+    try {
+      if (spec.function) iFace.getFunction(spec.function)
+      else iFace.getEvent(spec.event)
+      return iFace
+    } catch (err) {
+      // not in this abi
+    }
+  }
+  throw new Error(
+    `No abi found for ${spec.contract} with ${spec.function || spec.event}`
+  )
+}
+
+/**
+ * Generate the codecs from the abis in a set of compiled contract artifacts
+ * @param artifactFiles
+ */
+const genFastCodecs = artifactFiles => {
+  const abis = new Map()
+  for (const file of artifactFiles) {
+    const artifact = JSON.parse(readFileSync(file, 'utf8'))
+    if (!artifact.contractName || !artifact.abi) continue
+    const contractAbis = abis.get(artifact.contractName) || []
+    contractAbis.push(artifact.abi)
+    abis.set(artifact.contractName, contractAbis)
+  }
+
+  const source = new CodecWriter().write(abis)
+  const options = prettier.resolveConfig.sync(OUT_FILE)
+  writeFileSync(
+    OUT_FILE,
+    prettier.format(source, { ...options, parser: 'typescript' })
+  )
+}
+
+function main() {
+  const cwd = process.cwd()
+  const nitroPath = getPackagePath('@arbitrum/nitro-contracts')
+  const peripheralsPath = getPackagePath('arb-bridge-peripherals')
+
+  // the contracts are compiled by genAbi.js
+  const files = glob(cwd, [
+    `${peripheralsPath}/build/contracts/!(build-info)/**/+([a-zA-Z0-9_]).json`,
+    `${nitroPath}/build/contracts/!(build-info)/**/+([a-zA-Z0-9_]).json`,
+  ])
+  genFastCodecs(files)
+  console.log('Fast codecs generated')
+}
+
+module.exports = { genFastCodecs }
+
+if (require.main === module) main()
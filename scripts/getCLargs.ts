@@ -32,6 +32,9 @@ const argv = yargs(process.argv.slice(2))
     networkID: {
       type: 'number',
     },
+    iterations: {
+      type: 'number',
+    },
   })
   .parseSync()
 
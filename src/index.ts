@@ -27,6 +27,28 @@ export {
   L2ToL1MessageWriter,
   L2ToL1MessageReader,
 } from './lib/message/L2ToL1Message'
+export {
+  L2ToL1MessageTracker,
+  L2ToL1MessageTrackerOptions,
+  TrackedNode,
+} from './lib/message/L2ToL1MessageTracker'
+export {
+  CachedRollupNode,
+  RollupNodeCache,
+  RollupNodeInfo,
+  RollupNodeStatus,
+} from './lib/message/RollupNodeCache'
+export { ConfirmedNodeWatcher } from './lib/message/ConfirmedNodeWatcher'
+export {
+  L2ToL1MessageBatchExecutor,
+  L2ToL1BatchExecuteOptions,
+  L2ToL1BatchExecuteResult,
+} from './lib/message/L2ToL1MessageBatchExecutor'
+export {
+  IndexedTicket,
+  RetryableRedeemScanner,
+  RetryableRedeemScannerOptions,
+} from './lib/message/RetryableRedeemScanner'
 export {
   L1ContractTransaction,
   L1TransactionReceipt,
@@ -41,7 +63,15 @@ export {
 } from './lib/message/L1ToL2Message'
 export { L1ToL2MessageGasEstimator } from './lib/message/L1ToL2MessageGasEstimator'
 export { argSerializerConstructor } from './lib/utils/byte_serialize_params'
-export { CallInput, MultiCaller } from './lib/utils/multicall'
+export {
+  CallInput,
+  MultiCaller,
+  MultiCallChunkOptions,
+} from './lib/utils/multicall'
+export {
+  MultiCallBatchProvider,
+  MultiCallBatchOptions,
+} from './lib/utils/multicallBatchProvider'
 export {
   L1Networks,
   L2Networks,
@@ -53,7 +83,37 @@ export {
   addDefaultLocalNetwork,
 } from './lib/dataEntities/networks'
 export { InboxTools } from './lib/inbox/inbox'
-export { EventFetcher } from './lib/utils/eventFetcher'
+export {
+  EventFetcher,
+  EventCursor,
+  EventPage,
+  EventStreamOptions,
+} from './lib/utils/eventFetcher'
+export {
+  JsonRpcBatcher,
+  JsonRpcBatcherOptions,
+} from './lib/utils/jsonRpcBatcher'
+export { TransactionReceiptWaiter } from './lib/utils/receiptWaiter'
+export {
+  HeadTracker,
+  HeadTrackerOptions,
+  ChainHead,
+} from './lib/utils/headTracker'
+export {
+  LogCache,
+  LogCacheStore,
+  LogCacheChunk,
+  LogCacheOptions,
+  InMemoryLogCacheStore,
+} from './lib/utils/logCache'
+export {
+  RpcResultCache,
+  RpcResultCacheStore,
+  RpcResultCacheOptions,
+  InMemoryRpcResultCacheStore,
+} from './lib/utils/rpcResultCache'
+export { ArbitrumProvider } from './lib/utils/arbProvider'
+export { getInterface } from './lib/utils/contractCache'
 export * as constants from './lib/dataEntities/constants'
 export { L2ToL1MessageStatus } from './lib/dataEntities/message'
 export {
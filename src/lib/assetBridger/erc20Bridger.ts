@@ -25,10 +25,14 @@ import {
 import { PayableOverrides, Overrides } from '@ethersproject/contracts'
 import { MaxUint256 } from '@ethersproject/constants'
 import { ErrorCode, Logger } from '@ethersproject/logger'
-import { BigNumber, BigNumberish, ethers, BytesLike } from 'ethers'
+import { BigNumber, ethers } from 'ethers'
 
 import { L1GatewayRouter__factory } from '../abi/factories/L1GatewayRouter__factory'
 import { L2GatewayRouter__factory } from '../abi/factories/L2GatewayRouter__factory'
+import {
+  encodeL1OutboundTransfer,
+  encodeL2OutboundTransfer,
+} from '../abi/fastCodecs'
 import { L1WethGateway__factory } from '../abi/factories/L1WethGateway__factory'
 import { L2ArbitrumGateway__factory } from '../abi/factories/L2ArbitrumGateway__factory'
 import { ERC20__factory } from '../abi/factories/ERC20__factory'
@@ -48,7 +52,11 @@ import { SignerProviderUtils } from '../dataEntities/signerOrProvider'
 import { L2Network, getL2Network } from '../dataEntities/networks'
 import { ArbSdkError, MissingProviderArbSdkError } from '../dataEntities/errors'
 import { DISABLED_GATEWAY } from '../dataEntities/constants'
-import { EventFetcher } from '../utils/eventFetcher'
+import {
+  EventFetcher,
+  EventPage,
+  EventStreamOptions,
+} from '../utils/eventFetcher'
 import { EthDepositParams, EthWithdrawParams } from './ethBridger'
 import { AssetBridger } from './assetBridger'
 import {
@@ -66,11 +74,16 @@ import {
   L1ToL2TransactionRequest,
   L2ToL1TransactionRequest,
 } from '../dataEntities/transactionRequest'
-import { defaultAbiCoder } from 'ethers/lib/utils'
+import { defaultAbiCoder, getAddress } from 'ethers/lib/utils'
 import { OmitTyped, RequiredPick } from '../utils/types'
 import { RetryableDataTools } from '../dataEntities/retryableData'
 import { EventArgs } from '../dataEntities/event'
 import { L1ToL2MessageGasParams } from '../message/L1ToL2MessageCreator'
+import {
+  connectContract,
+  createContract,
+  getInterface,
+} from '../utils/contractCache'
 
 export interface TokenApproveParams {
   /**
@@ -203,7 +216,8 @@ export class Erc20Bridger extends AssetBridger<
   ): Promise<string> {
     await this.checkL1Network(l1Provider)
 
-    return await L1GatewayRouter__factory.connect(
+    return await connectContract(
+      L1GatewayRouter__factory,
       this.l2Network.tokenBridge.l1GatewayRouter,
       l1Provider
     ).getGateway(erc20L1Address)
@@ -221,7 +235,8 @@ export class Erc20Bridger extends AssetBridger<
   ): Promise<string> {
     await this.checkL2Network(l2Provider)
 
-    return await L2GatewayRouter__factory.connect(
+    return await connectContract(
+      L2GatewayRouter__factory,
       this.l2Network.tokenBridge.l2GatewayRouter,
       l2Provider
     ).getGateway(erc20L1Address)
@@ -242,7 +257,7 @@ export class Erc20Bridger extends AssetBridger<
       SignerProviderUtils.getProviderOrThrow(params.l1Provider)
     )
 
-    const iErc20Interface = ERC20__factory.createInterface()
+    const iErc20Interface = getInterface(ERC20__factory)
     const data = iErc20Interface.encodeFunctionData('approve', [
       gatewayAddress,
       params.amount || Erc20Bridger.MAX_APPROVAL,
@@ -320,6 +335,48 @@ export class Erc20Bridger extends AssetBridger<
       : events
   }
 
+  /**
+   * Stream the L2 events created by withdrawals page by page, see EventFetcher.streamEvents
+   * @param l2Provider
+   * @param gatewayAddress
+   * @param filter
+   * @param l1TokenAddress
+   * @param fromAddress
+   * @param options Paging options and an optional cursor to resume from
+   * @returns
+   */
+  public async *streamL2WithdrawalEvents(
+    l2Provider: Provider,
+    gatewayAddress: string,
+    filter: { fromBlock: BlockTag; toBlock: BlockTag },
+    l1TokenAddress?: string,
+    fromAddress?: string,
+    options?: EventStreamOptions
+  ): AsyncGenerator<
+    EventPage<EventArgs<WithdrawalInitiatedEvent> & { txHash: string }>
+  > {
+    await this.checkL2Network(l2Provider)
+
+    const eventFetcher = new EventFetcher(l2Provider)
+    for await (const page of eventFetcher.streamEvents(
+      L2ArbitrumGateway__factory,
+      contract =>
+        contract.filters.WithdrawalInitiated(null, fromAddress || null),
+      { ...filter, address: gatewayAddress },
+      options
+    )) {
+      const events = page.events
+        .map(a => ({ txHash: a.transactionHash, ...a.event }))
+        .filter(
+          log =>
+            !l1TokenAddress ||
+            log.l1Token.toLocaleLowerCase() ===
+              l1TokenAddress.toLocaleLowerCase()
+        )
+      yield { events, cursor: page.cursor }
+    }
+  }
+
   /**
    * Does the provided address look like a weth gateway
    * @param potentialWethGatewayAddress
@@ -331,7 +388,8 @@ export class Erc20Bridger extends AssetBridger<
     l1Provider: Provider
   ) {
     try {
-      const potentialWethGateway = L1WethGateway__factory.connect(
+      const potentialWethGateway = connectContract(
+        L1WethGateway__factory,
         potentialWethGatewayAddress,
         l1Provider
       )
@@ -386,7 +444,7 @@ export class Erc20Bridger extends AssetBridger<
     l2Provider: Provider,
     l2TokenAddr: string
   ): L2GatewayToken {
-    return L2GatewayToken__factory.connect(l2TokenAddr, l2Provider)
+    return createContract(L2GatewayToken__factory, l2TokenAddr, l2Provider)
   }
 
   /**
@@ -399,7 +457,7 @@ export class Erc20Bridger extends AssetBridger<
    * @returns
    */
   public getL1TokenContract(l1Provider: Provider, l1TokenAddr: string): ERC20 {
-    return ERC20__factory.connect(l1TokenAddr, l1Provider)
+    return createContract(ERC20__factory, l1TokenAddr, l1Provider)
   }
 
   /**
@@ -414,7 +472,8 @@ export class Erc20Bridger extends AssetBridger<
   ): Promise<string> {
     await this.checkL1Network(l1Provider)
 
-    const l1GatewayRouter = L1GatewayRouter__factory.connect(
+    const l1GatewayRouter = connectContract(
+      L1GatewayRouter__factory,
       this.l2Network.tokenBridge.l1GatewayRouter,
       l1Provider
     )
@@ -445,11 +504,16 @@ export class Erc20Bridger extends AssetBridger<
       return this.l2Network.tokenBridge.l1Weth
     }
 
-    const arbERC20 = L2GatewayToken__factory.connect(erc20L2Address, l2Provider)
+    const arbERC20 = connectContract(
+      L2GatewayToken__factory,
+      erc20L2Address,
+      l2Provider
+    )
     const l1Address = await arbERC20.functions.l1Address().then(([res]) => res)
 
     // check that this l1 address is indeed registered to this l2 token
-    const l2GatewayRouter = L2GatewayRouter__factory.connect(
+    const l2GatewayRouter = connectContract(
+      L2GatewayRouter__factory,
       this.l2Network.tokenBridge.l2GatewayRouter,
       l2Provider
     )
@@ -476,7 +540,8 @@ export class Erc20Bridger extends AssetBridger<
   ): Promise<boolean> {
     await this.checkL1Network(l1Provider)
 
-    const l1GatewayRouter = L1GatewayRouter__factory.connect(
+    const l1GatewayRouter = connectContract(
+      L1GatewayRouter__factory,
       this.l2Network.tokenBridge.l1GatewayRouter,
       l1Provider
     )
@@ -541,17 +606,17 @@ export class Erc20Bridger extends AssetBridger<
         ['uint256', 'bytes'],
         [depositParams.maxSubmissionCost, '0x']
       )
-      const iGatewayRouter = L1GatewayRouter__factory.createInterface()
 
       return {
-        data: iGatewayRouter.encodeFunctionData('outboundTransfer', [
-          erc20L1Address,
-          destinationAddress,
+        // the fast encoder does not verify checksums, so check the user's addresses
+        data: encodeL1OutboundTransfer(
+          getAddress(erc20L1Address),
+          getAddress(destinationAddress),
           amount,
           depositParams.gasLimit,
           depositParams.maxFeePerGas,
-          innerData,
-        ]),
+          innerData
+        ),
         to: this.l2Network.tokenBridge.l1GatewayRouter,
         from: defaultedParams.from,
         value: depositParams.gasLimit
@@ -642,23 +707,13 @@ export class Erc20Bridger extends AssetBridger<
   ): Promise<L2ToL1TransactionRequest> {
     const to = params.destinationAddress
 
-    const routerInterface = L2GatewayRouter__factory.createInterface()
-    const functionData =
-      // we need to do this since typechain doesnt seem to correctly create
-      // encodeFunctionData for functions with overrides
-      (
-        routerInterface as unknown as {
-          encodeFunctionData(
-            functionFragment: 'outboundTransfer(address,address,uint256,bytes)',
-            values: [string, string, BigNumberish, BytesLike]
-          ): string
-        }
-      ).encodeFunctionData('outboundTransfer(address,address,uint256,bytes)', [
-        params.erc20l1Address,
-        to,
-        params.amount,
-        '0x',
-      ])
+    // the fast encoder does not verify checksums, so check the user's addresses
+    const functionData = encodeL2OutboundTransfer(
+      getAddress(params.erc20l1Address),
+      getAddress(to),
+      params.amount,
+      '0x'
+    )
 
     return {
       txRequest: {
@@ -753,8 +808,16 @@ export class AdminErc20Bridger extends Erc20Bridger {
 
     const l1SenderAddress = await l1Signer.getAddress()
 
-    const l1Token = ICustomToken__factory.connect(l1TokenAddress, l1Signer)
-    const l2Token = IArbToken__factory.connect(l2TokenAddress, l2Provider)
+    const l1Token = connectContract(
+      ICustomToken__factory,
+      l1TokenAddress,
+      l1Signer
+    )
+    const l2Token = connectContract(
+      IArbToken__factory,
+      l2TokenAddress,
+      l2Provider
+    )
 
     // sanity checks
     await l1Token.deployed()
@@ -930,7 +993,8 @@ export class AdminErc20Bridger extends Erc20Bridger {
 
     const from = await l1Signer.getAddress()
 
-    const l1GatewayRouter = L1GatewayRouter__factory.connect(
+    const l1GatewayRouter = connectContract(
+      L1GatewayRouter__factory,
       this.l2Network.tokenBridge.l1GatewayRouter,
       l1Signer
     )
@@ -46,6 +46,7 @@ import { OmitTyped } from '../utils/types'
 import { SignerProviderUtils } from '../dataEntities/signerOrProvider'
 import { MissingProviderArbSdkError } from '../dataEntities/errors'
 import { getL2Network } from '../dataEntities/networks'
+import { getInterface } from '../utils/contractCache'
 
 export interface EthWithdrawParams {
   /**
@@ -149,7 +150,7 @@ export class EthBridger extends AssetBridger<
   public async getDepositRequest(
     params: EthDepositRequestParams
   ): Promise<OmitTyped<L1ToL2TransactionRequest, 'retryableData'>> {
-    const inboxInterface = Inbox__factory.createInterface()
+    const inboxInterface = getInterface(Inbox__factory)
 
     const functionData = (
       inboxInterface as unknown as {
@@ -260,7 +261,7 @@ export class EthBridger extends AssetBridger<
   public async getWithdrawalRequest(
     params: EthWithdrawParams
   ): Promise<L2ToL1TransactionRequest> {
-    const iArbSys = ArbSys__factory.createInterface()
+    const iArbSys = getInterface(ArbSys__factory)
     const functionData = iArbSys.encodeFunctionData('withdrawEth', [
       params.destinationAddress,
     ])
@@ -39,3 +39,26 @@ export class MissingProviderArbSdkError extends ArbSdkError {
     )
   }
 }
+
+/**
+ * The messages of an error, including those of the JSON-RPC error and response body
+ * that ethers attaches to the errors of failed requests
+ */
+export const errorText = (err: unknown): string => {
+  const e = err as { message?: string; body?: string; error?: Error }
+  return [e?.message, e?.error?.message, e?.body]
+    .filter((t): t is string => t !== undefined && t !== null)
+    .join(' ')
+}
+
+/**
+ * Rate limited requests should be retried after a delay. Their messages can look like
+ * result limits ("limit exceeded", "too many requests"), so check for them first
+ */
+export const isRateLimitError = (err: unknown): boolean => {
+  const e = err as { status?: number; error?: { status?: number } }
+  if (e?.status === 429 || e?.error?.status === 429) return true
+  return [/429/, /rate.?limit/i, /too many requests/i].some(r =>
+    r.test(errorText(err))
+  )
+}
@@ -1,7 +1,9 @@
 import { TypedEvent, TypedEventFilter } from '../abi/common'
 import { Contract } from 'ethers'
 import { Provider, Log } from '@ethersproject/abstract-provider'
-import { Interface } from 'ethers/lib/utils'
+import { EventFragment, Interface, Result } from 'ethers/lib/utils'
+import { getInterface } from '../utils/contractCache'
+import { ArbSdkError } from './errors'
 
 /**
  * The type of the event arguments.
@@ -43,6 +45,64 @@ export type TypeChainContractFactory<TContract extends Contract> = {
   createInterface(): Interface
 }
 
+/**
+ * Decodes logs for a contract, with the interface and topic lookups built once
+ */
+export class LogDecoder {
+  private readonly fragmentsByTopic = new Map<string, EventFragment>()
+
+  public constructor(public readonly iFace: Interface) {
+    for (const fragment of Object.values(iFace.events)) {
+      this.fragmentsByTopic.set(iFace.getEventTopic(fragment), fragment)
+    }
+  }
+
+  /**
+   * Get the event fragment for a topic
+   * @param topic
+   * @returns Undefined if the contract has no event with this topic
+   */
+  public getFragment(topic: string): EventFragment | undefined {
+    return this.fragmentsByTopic.get(topic)
+  }
+
+  /**
+   * Decode the args of a log
+   * @param log
+   * @param fragment The event fragment of the log, looked up from the first topic if not provided
+   */
+  public decodeArgs(
+    log: { topics: string[]; data: string },
+    fragment = this.getFragment(log.topics[0])
+  ): Result {
+    if (!fragment) {
+      throw new ArbSdkError(`No event found for topic ${log.topics[0]}`)
+    }
+    return this.iFace.decodeEventLog(fragment, log.data, log.topics)
+  }
+}
+
+const logDecoders = new WeakMap<
+  TypeChainContractFactory<Contract>,
+  LogDecoder
+>()
+
+/**
+ * Get the log decoder for a contract factory, created once per factory
+ * @param contractFactory
+ * @returns
+ */
+export const getLogDecoder = <TContract extends Contract>(
+  contractFactory: TypeChainContractFactory<TContract>
+): LogDecoder => {
+  let decoder = logDecoders.get(contractFactory)
+  if (!decoder) {
+    decoder = new LogDecoder(getInterface(contractFactory))
+    logDecoders.set(contractFactory, decoder)
+  }
+  return decoder
+}
+
 /**
  * Parse a log that matches a given filter name.
  * @param contractFactory
@@ -58,12 +118,18 @@ export const parseTypedLog = <
   log: Log,
   filterName: TFilterName
 ): EventType<TContract, TFilterName> | null => {
-  const iFace = contractFactory.createInterface()
-  const event = iFace.getEvent(filterName)
-  const topic = iFace.getEventTopic(event)
+  const decoder = getLogDecoder(contractFactory)
+  const fragment = decoder.getFragment(log.topics[0])
 
-  if (log.topics[0] === topic) {
-    return iFace.parseLog(log).args as EventType<TContract, TFilterName>
+  // filter names can be the event name or the full signature
+  if (
+    fragment &&
+    (fragment.name === filterName || fragment.format() === filterName)
+  ) {
+    return decoder.decodeArgs(log, fragment) as EventType<
+      TContract,
+      TFilterName
+    >
   } else return null
 }
 
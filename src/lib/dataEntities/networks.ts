@@ -20,6 +20,7 @@ import { SignerOrProvider, SignerProviderUtils } from './signerOrProvider'
 import { ArbSdkError } from '../dataEntities/errors'
 import { SEVEN_DAYS_IN_SECONDS } from './constants'
 import { RollupAdminLogic__factory } from '../abi/factories/RollupAdminLogic__factory'
+import { connectContract } from '../utils/contractCache'
 
 export interface L1Network extends Network {
   partnerChainIDs: number[]
@@ -256,12 +257,7 @@ const getNetwork = async (
     if (typeof signerOrProviderOrChainID === 'number') {
       return signerOrProviderOrChainID
     }
-    const provider = SignerProviderUtils.getProviderOrThrow(
-      signerOrProviderOrChainID
-    )
-
-    const { chainId } = await provider.getNetwork()
-    return chainId
+    return await SignerProviderUtils.getChainId(signerOrProviderOrChainID)
   })()
 
   const networks = layer === 1 ? l1Networks : l2Networks
@@ -293,7 +289,8 @@ export const getEthBridgeInformation = async (
   rollupContractAddress: string,
   l1SignerOrProvider: SignerOrProvider
 ): Promise<EthBridge> => {
-  const rollup = RollupAdminLogic__factory.connect(
+  const rollup = connectContract(
+    RollupAdminLogic__factory,
     rollupContractAddress,
     l1SignerOrProvider
   )
@@ -9,6 +9,8 @@ export type SignerOrProvider = Signer | Provider
  * Utility functions for signer/provider union types
  */
 export class SignerProviderUtils {
+  private static readonly chainIds = new WeakMap<Provider, Promise<number>>()
+
   public static isSigner(
     signerOrProvider: SignerOrProvider
   ): signerOrProvider is Signer {
@@ -47,9 +49,47 @@ export class SignerProviderUtils {
     return isDefined(signer.provider)
   }
 
+  /**
+   * Get the chain id of the signer/provider's provider. The chain id is looked up once
+   * per provider, and lookups in flight at the same time share a single request.
+   * Providers created with the "any" network can switch chains, so they are looked up
+   * every time. Other providers that can switch chains should call invalidateChainId
+   * when they do so
+   * @param signerOrProvider
+   * @returns
+   */
+  public static async getChainId(
+    signerOrProvider: SignerOrProvider
+  ): Promise<number> {
+    const provider = this.getProviderOrThrow(signerOrProvider)
+    if ((provider as { anyNetwork?: boolean }).anyNetwork) {
+      return (await provider.getNetwork()).chainId
+    }
+    let chainId = this.chainIds.get(provider)
+    if (!chainId) {
+      chainId = provider.getNetwork().then(n => n.chainId)
+      this.chainIds.set(provider, chainId)
+      // failed lookups are not remembered
+      chainId.catch(() => this.chainIds.delete(provider))
+    }
+    return await chainId
+  }
+
+  /**
+   * Forget the remembered chain id of the signer/provider's provider, so that it
+   * is looked up again on next use
+   * @param signerOrProvider
+   */
+  public static invalidateChainId(signerOrProvider: SignerOrProvider): void {
+    const provider = this.getProvider(signerOrProvider)
+    if (provider) this.chainIds.delete(provider)
+  }
+
   /**
    * Checks that the signer/provider that's provider matches the chain id
    * Throws if not.
+   * The chain id is always looked up afresh rather than remembered, so that this
+   * catches wallets that have switched chains
    * @param signerOrProvider
    * @param chainId
    */
@@ -57,10 +97,11 @@ export class SignerProviderUtils {
     signerOrProvider: SignerOrProvider,
     chainId: number
   ): Promise<void> {
-    const provider = this.getProvider(signerOrProvider)
-    if (!provider) throw new MissingProviderArbSdkError('signerOrProvider')
+    const provider = this.getProviderOrThrow(signerOrProvider)
 
     const providerChainId = (await provider.getNetwork()).chainId
+    // refresh the remembered chain id too, in case the provider has switched
+    this.chainIds.set(provider, Promise.resolve(providerChainId))
     if (providerChainId !== chainId) {
       throw new ArbSdkError(
         `Signer/provider chain id: ${providerChainId} doesn't match provided chain id: ${chainId}.`
@@ -37,6 +37,7 @@ import { NodeInterface__factory } from '../abi/factories/NodeInterface__factory'
 import { NODE_INTERFACE_ADDRESS } from '../dataEntities/constants'
 import { InboxMessageKind } from '../dataEntities/message'
 import { isDefined } from '../utils/lib'
+import { connectContract } from '../utils/contractCache'
 
 type ForceInclusionParams = FetchedEvent<MessageDeliveredEvent> & {
   delayedAcc: string
@@ -121,7 +122,8 @@ export class InboxTools {
     transactionl2Request: RequiredTransactionRequestType,
     l2Provider: Provider
   ): Promise<GasComponentsWithL2Part> {
-    const nodeInterface = NodeInterface__factory.connect(
+    const nodeInterface = connectContract(
+      NodeInterface__factory,
       NODE_INTERFACE_ADDRESS,
       l2Provider
     )
@@ -148,7 +150,8 @@ export class InboxTools {
    * @returns
    */
   private async getForceIncludableBlockRange(blockNumberRangeSize: number) {
-    const sequencerInbox = SequencerInbox__factory.connect(
+    const sequencerInbox = connectContract(
+      SequencerInbox__factory,
       this.l2Network.ethBridge.sequencerInbox,
       this.l1Provider
     )
@@ -257,7 +260,8 @@ export class InboxTools {
     startSearchRangeBlocks = 100,
     rangeMultipler = 2
   ): Promise<ForceInclusionParams | null> {
-    const bridge = Bridge__factory.connect(
+    const bridge = connectContract(
+      Bridge__factory,
       this.l2Network.ethBridge.bridge,
       this.l1Provider
     )
@@ -276,7 +280,8 @@ export class InboxTools {
 
     // take the last event - as including this one will include all previous events
     const eventInfo = events[events.length - 1]
-    const sequencerInbox = SequencerInbox__factory.connect(
+    const sequencerInbox = connectContract(
+      SequencerInbox__factory,
       this.l2Network.ethBridge.sequencerInbox,
       this.l1Provider
     )
@@ -316,7 +321,8 @@ export class InboxTools {
     messageDeliveredEvent?: T,
     overrides?: Overrides
   ): Promise<ContractTransaction | null> {
-    const sequencerInbox = SequencerInbox__factory.connect(
+    const sequencerInbox = connectContract(
+      SequencerInbox__factory,
       this.l2Network.ethBridge.sequencerInbox,
       this.l1Signer
     )
@@ -349,7 +355,8 @@ export class InboxTools {
   public async sendL2SignedTx(
     signedTx: string
   ): Promise<ContractTransaction | null> {
-    const delayedInbox = IInbox__factory.connect(
+    const delayedInbox = connectContract(
+      IInbox__factory,
       this.l2Network.ethBridge.inbox,
       this.l1Signer
     )
@@ -0,0 +1,200 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { Provider } from '@ethersproject/abstract-provider'
+import { BigNumber } from '@ethersproject/bignumber'
+import { Logger } from '@ethersproject/logger'
+
+import { RollupUserLogic } from '../abi/RollupUserLogic'
+import { ArbSdkError } from '../dataEntities/errors'
+import { RollupNodeCache, RollupNodeStatus } from './RollupNodeCache'
+
+type Waiter = {
+  position: BigNumber
+  pollIntervalMs: number
+  resolve: () => void
+  reject: (err: unknown) => void
+}
+
+// max delay between polls after consecutive poll errors
+const MAX_ERROR_BACKOFF_MS = 60000
+
+/**
+ * Errors that polling again will not fix, eg. the rollup contract reverting
+ */
+const isTerminalError = (err: unknown): boolean =>
+  (err as { code?: string })?.code === Logger.errors.CALL_EXCEPTION
+
+/**
+ * Watches the latest confirmed node of a rollup on behalf of any number of waiting
+ * L2->L1 messages. A single poll of latestConfirmed() is shared by all waiters, the
+ * confirmed node is only resolved when it changes, and each waiter is woken as soon
+ * as the confirmed send count covers its position. Polling stops when nobody is waiting.
+ * Failed polls are retried with an exponential backoff, only errors that retrying cannot
+ * fix are passed on to the waiters.
+ */
+export class ConfirmedNodeWatcher {
+  private static readonly watchers = new WeakMap<
+    Provider,
+    WeakMap<Provider, Map<string, ConfirmedNodeWatcher>>
+  >()
+
+  private readonly waiters = new Set<Waiter>()
+  private timer?: ReturnType<typeof setTimeout>
+  private consecutiveErrors = 0
+  private latestConfirmedNum?: BigNumber
+  private confirmedSendCount?: BigNumber
+
+  /**
+   * @param rollup
+   * @param l2Provider
+   * @param nodeCache Defaults to the process wide RollupNodeCache.shared
+   */
+  public constructor(
+    public readonly rollup: RollupUserLogic,
+    private readonly l2Provider: Provider,
+    private readonly nodeCache: RollupNodeCache = RollupNodeCache.shared
+  ) {}
+
+  /**
+   * Get the watcher shared by all users of this rollup with the same rollup and L2 providers
+   * @param rollup
+   * @param l2Provider
+   * @returns
+   */
+  public static forRollup(
+    rollup: RollupUserLogic,
+    l2Provider: Provider
+  ): ConfirmedNodeWatcher {
+    let byL2Provider = this.watchers.get(rollup.provider)
+    if (!byL2Provider) {
+      byL2Provider = new WeakMap()
+      this.watchers.set(rollup.provider, byL2Provider)
+    }
+    let watchers = byL2Provider.get(l2Provider)
+    if (!watchers) {
+      watchers = new Map()
+      byL2Provider.set(l2Provider, watchers)
+    }
+    const key = rollup.address.toLowerCase()
+    let watcher = watchers.get(key)
+    if (!watcher) {
+      watcher = new ConfirmedNodeWatcher(rollup, l2Provider)
+      watchers.set(key, watcher)
+    }
+    return watcher
+  }
+
+  /**
+   * Wait until the latest confirmed node includes the message at this position
+   * @param position
+   * @param pollIntervalMs How often to check the latest confirmed node. The watcher polls at the shortest interval of its waiters
+   * @param signal Rejects the wait when aborted
+   */
+  public waitForPosition(
+    position: BigNumber,
+    pollIntervalMs = 500,
+    signal?: AbortSignal
+  ): Promise<void> {
+    return new Promise((resolve, reject) => {
+      if (signal?.aborted) {
+        reject(new ArbSdkError('Wait aborted.'))
+        return
+      }
+      if (this.confirmedSendCount && this.confirmedSendCount.gt(position)) {
+        resolve()
+        return
+      }
+
+      const onAbort = () => {
+        this.waiters.delete(waiter)
+        reject(new ArbSdkError('Wait aborted.'))
+      }
+      const waiter: Waiter = {
+        position,
+        pollIntervalMs,
+        resolve: () => {
+          signal?.removeEventListener('abort', onAbort)
+          resolve()
+        },
+        reject: (err: unknown) => {
+          signal?.removeEventListener('abort', onAbort)
+          reject(err)
+        },
+      }
+      signal?.addEventListener('abort', onAbort)
+      this.waiters.add(waiter)
+      this.schedulePoll()
+    })
+  }
+
+  private schedulePoll() {
+    if (this.timer || this.waiters.size === 0) return
+    const interval = Math.min(
+      ...Array.from(this.waiters).map(w => w.pollIntervalMs)
+    )
+    const delay = Math.min(
+      interval * 2 ** this.consecutiveErrors,
+      Math.max(interval, MAX_ERROR_BACKOFF_MS)
+    )
+    this.timer = setTimeout(() => this.poll(), delay)
+  }
+
+  private async poll(): Promise<void> {
+    try {
+      await this.updateConfirmed()
+      const sendCount = this.confirmedSendCount
+      for (const waiter of Array.from(this.waiters)) {
+        if (sendCount && sendCount.gt(waiter.position)) {
+          this.waiters.delete(waiter)
+          waiter.resolve()
+        }
+      }
+      this.consecutiveErrors = 0
+    } catch (err) {
+      // transient errors, eg. a dropped connection or a rate limit, are retried with a
+      // backoff. Others are passed on to the waiters
+      if (!isTerminalError(err)) this.consecutiveErrors++
+      else {
+        for (const waiter of Array.from(this.waiters)) waiter.reject(err)
+        this.waiters.clear()
+        this.consecutiveErrors = 0
+      }
+    }
+    this.timer = undefined
+    this.schedulePoll()
+  }
+
+  private async updateConfirmed(): Promise<void> {
+    const latestConfirmedNum = await this.rollup.callStatic.latestConfirmed()
+    if (
+      this.latestConfirmedNum &&
+      this.latestConfirmedNum.eq(latestConfirmedNum)
+    )
+      return
+
+    const node = await this.nodeCache.getNode(
+      this.rollup,
+      latestConfirmedNum,
+      this.l2Provider,
+      RollupNodeStatus.CONFIRMED
+    )
+    this.latestConfirmedNum = latestConfirmedNum
+    this.confirmedSendCount = node.sendCount
+  }
+}
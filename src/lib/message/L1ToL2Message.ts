@@ -26,6 +26,12 @@ import { getAddress } from '@ethersproject/address'
 import { keccak256 } from '@ethersproject/keccak256'
 
 import { ArbRetryableTx__factory } from '../abi/factories/ArbRetryableTx__factory'
+import {
+  LifetimeExtendedEvent,
+  RedeemScheduledEvent,
+} from '../abi/ArbRetryableTx'
+import { decodeRedeemScheduledEvent } from '../abi/fastCodecs'
+import { TypedEventFilter } from '../abi/common'
 import { ARB_RETRYABLE_TX_ADDRESS } from '../dataEntities/constants'
 import {
   SignerProviderUtils,
@@ -36,8 +42,28 @@ import { ethers, Overrides } from 'ethers'
 import { L2TransactionReceipt, RedeemTransaction } from './L2Transaction'
 import { getL2Network } from '../../lib/dataEntities/networks'
 import { RetryableMessageParams } from '../dataEntities/message'
-import { getTransactionReceipt, isDefined } from '../utils/lib'
+import {
+  getTransactionReceipt,
+  isDefined,
+  mapConcurrently,
+} from '../utils/lib'
+import { getTransactionReceipts } from '../utils/jsonRpcBatcher'
+import { HeadTracker } from '../utils/headTracker'
+import { MultiCaller } from '../utils/multicall'
 import { EventFetcher } from '../utils/eventFetcher'
+import { EventArgs } from '../dataEntities/event'
+import {
+  IndexedTicket,
+  RetryableRedeemScanner,
+} from './RetryableRedeemScanner'
+import { connectContract, getInterface } from '../utils/contractCache'
+
+// min number of blocks in a window when searching for a manual redeem
+const MIN_REDEEM_SEARCH_WINDOW = 1000
+// max number of windows searched at once
+const REDEEM_SEARCH_CONCURRENCY = 4
+// max number of messages searched for a manual redeem at once in bulkStatus
+const BULK_REDEEM_SEARCH_CONCURRENCY = 8
 
 export enum L1ToL2MessageStatus {
   /**
@@ -236,6 +262,10 @@ export type EthDepositMessageWaitResult = {
 
 export class L1ToL2MessageReader extends L1ToL2Message {
   private retryableCreationReceipt: TransactionReceipt | undefined | null
+  // results that can no longer change once found, so are only fetched once
+  private autoRedeemAttempt: TransactionReceipt | undefined | null
+  private creationBlockTimestamp: number | undefined
+  private terminalResult: L1ToL2MessageWaitResult | undefined
   public constructor(
     public readonly l2Provider: Provider,
     chainId: number,
@@ -275,6 +305,8 @@ export class L1ToL2MessageReader extends L1ToL2Message {
    * @returns TransactionReceipt of the auto redeem attempt if exists, otherwise null
    */
   public async getAutoRedeemAttempt(): Promise<TransactionReceipt | null> {
+    if (this.autoRedeemAttempt !== undefined) return this.autoRedeemAttempt
+
     const creationReceipt = await this.getRetryableCreationReceipt()
 
     if (creationReceipt) {
@@ -282,14 +314,21 @@ export class L1ToL2MessageReader extends L1ToL2Message {
       const redeemEvents = l2Receipt.getRedeemScheduledEvents()
 
       if (redeemEvents.length === 1) {
-        return await this.l2Provider.getTransactionReceipt(
+        // the auto redeem is executed in the block after the ticket is created,
+        // so it is only remembered once it has been mined
+        const autoRedeem = await getTransactionReceipt(
+          this.l2Provider,
           redeemEvents[0].retryTxHash
         )
+        if (autoRedeem) this.autoRedeemAttempt = autoRedeem
+        return autoRedeem
       } else if (redeemEvents.length > 1) {
         throw new ArbSdkError(
           `Unexpected number of redeem events for retryable creation tx. ${creationReceipt} ${redeemEvents}`
         )
       }
+      // no auto redeem was scheduled when the ticket was created
+      this.autoRedeemAttempt = null
     }
 
     return null
@@ -297,11 +336,189 @@ export class L1ToL2MessageReader extends L1ToL2Message {
 
   /**
    * Receipt for the successful l2 transaction created by this message.
+   * @param redeemScanner If provided, and the ticket is in its index, the status is resolved
+   * from the index after syncing it, rather than by looking up the ticket and its redeems.
+   * Redeemed and creation failed results are remembered, so later calls make no requests.
+   * Expired results are not, as they can come from a node that lags behind a redeem
    * @returns TransactionReceipt of the first successful redeem if exists, otherwise the current status of the message.
    */
-  public async getSuccessfulRedeem(): Promise<L1ToL2MessageWaitResult> {
-    const l2Network = await getL2Network(this.l2Provider)
-    const eventFetcher = new EventFetcher(this.l2Provider)
+  public async getSuccessfulRedeem(
+    redeemScanner?: RetryableRedeemScanner
+  ): Promise<L1ToL2MessageWaitResult> {
+    if (this.terminalResult) return this.terminalResult
+
+    return this.rememberResult(await this.findSuccessfulRedeem(redeemScanner))
+  }
+
+  private rememberResult(
+    result: L1ToL2MessageWaitResult
+  ): L1ToL2MessageWaitResult {
+    // the ticket can no longer change once redeemed or failed to be created. Expiry
+    // is inferred from the ticket no longer existing and no redeem being found, which
+    // a lagging node or log index can get wrong, so it is checked again on every call
+    if (
+      result.status === L1ToL2MessageStatus.REDEEMED ||
+      result.status === L1ToL2MessageStatus.CREATION_FAILED
+    ) {
+      this.terminalResult = result
+    }
+    return result
+  }
+
+  /**
+   * Get the statuses of many messages at once. The creation and auto redeem receipts are
+   * fetched in JSON-RPC batches, and whether the tickets still exist is checked with a
+   * multicall of getTimeout against a single latest block. Only messages whose ticket no
+   * longer exists and was not auto redeemed fall back to looking for a manual redeem.
+   * @param messages Messages on the same L2 provider
+   * @param redeemScanner Optional index of redeems, see getSuccessfulRedeem
+   * @returns Statuses in the same order as the messages
+   */
+  public static async bulkStatus(
+    messages: L1ToL2MessageReader[],
+    redeemScanner?: RetryableRedeemScanner
+  ): Promise<L1ToL2MessageStatus[]> {
+    if (messages.length === 0) return []
+    const l2Provider = messages[0].l2Provider
+    if (messages.some(m => m.l2Provider !== l2Provider)) {
+      throw new ArbSdkError('All messages must use the same L2 provider.')
+    }
+
+    const statuses: (L1ToL2MessageStatus | undefined)[] = messages.map(
+      m => m.terminalResult?.status
+    )
+    const setResult = (index: number, result: L1ToL2MessageWaitResult) => {
+      statuses[index] = messages[index].rememberResult(result).status
+    }
+    const pending = () =>
+      messages.map((_, i) => i).filter(i => !isDefined(statuses[i]))
+
+    // tickets in the scanner's index need no further requests
+    if (redeemScanner) {
+      await redeemScanner.sync()
+      for (const i of pending()) {
+        const ticket = redeemScanner.getTicket(messages[i].retryableCreationId)
+        if (ticket) setResult(i, L1ToL2MessageReader.resultFromTicket(ticket))
+      }
+    }
+
+    // creation receipts
+    const withoutCreation = pending().filter(
+      i => !messages[i].retryableCreationReceipt
+    )
+    const creationReceipts = await getTransactionReceipts(
+      l2Provider,
+      withoutCreation.map(i => messages[i].retryableCreationId)
+    )
+    withoutCreation.forEach((messageIndex, i) => {
+      messages[messageIndex].retryableCreationReceipt = creationReceipts[i]
+    })
+    for (const i of pending()) {
+      const creationReceipt = messages[i].retryableCreationReceipt
+      if (!creationReceipt) {
+        setResult(i, { status: L1ToL2MessageStatus.NOT_YET_CREATED })
+      } else if (creationReceipt.status === 0) {
+        setResult(i, { status: L1ToL2MessageStatus.CREATION_FAILED })
+      }
+    }
+
+    // auto redeem receipts
+    const autoRedeems: { index: number; retryTxHash: string }[] = []
+    for (const i of pending()) {
+      const message = messages[i]
+      if (message.autoRedeemAttempt !== undefined) continue
+      const redeemEvents = new L2TransactionReceipt(
+        message.retryableCreationReceipt!
+      ).getRedeemScheduledEvents()
+      if (redeemEvents.length === 0) message.autoRedeemAttempt = null
+      // more than one event is unexpected, leave it to getSuccessfulRedeem to report
+      else if (redeemEvents.length === 1) {
+        autoRedeems.push({ index: i, retryTxHash: redeemEvents[0].retryTxHash })
+      }
+    }
+    const autoRedeemReceipts = await getTransactionReceipts(
+      l2Provider,
+      autoRedeems.map(r => r.retryTxHash)
+    )
+    autoRedeems.forEach((r, i) => {
+      if (autoRedeemReceipts[i]) {
+        messages[r.index].autoRedeemAttempt = autoRedeemReceipts[i]
+      }
+    })
+    for (const i of pending()) {
+      const autoRedeem = messages[i].autoRedeemAttempt
+      if (autoRedeem && autoRedeem.status === 1) {
+        setResult(i, {
+          l2TxReceipt: autoRedeem,
+          status: L1ToL2MessageStatus.REDEEMED,
+        })
+      }
+    }
+
+    // whether the remaining tickets still exist
+    const remaining = pending()
+    if (remaining.length === 0) return statuses as L1ToL2MessageStatus[]
+    const arbRetryableIface = getInterface(ArbRetryableTx__factory)
+    const multiCaller = await MultiCaller.fromProvider(l2Provider)
+    const [timeouts, latestBlock] = await Promise.all([
+      multiCaller.multiCall(
+        remaining.map(i => ({
+          targetAddr: ARB_RETRYABLE_TX_ADDRESS,
+          encoder: () =>
+            arbRetryableIface.encodeFunctionData('getTimeout', [
+              messages[i].retryableCreationId,
+            ]),
+          decoder: (returnData: string) =>
+            arbRetryableIface.decodeFunctionResult(
+              'getTimeout',
+              returnData
+            )[0] as BigNumber,
+        }))
+      ),
+      HeadTracker.forProvider(l2Provider).getHead(),
+    ])
+    // getTimeout reverts for tickets that do not exist
+    const removed = remaining.filter((messageIndex, i) => {
+      const timeout = timeouts[i]
+      if (timeout && timeout.gte(latestBlock.timestamp)) {
+        statuses[messageIndex] = L1ToL2MessageStatus.FUNDS_DEPOSITED_ON_L2
+        return false
+      }
+      return true
+    })
+
+    // tickets that were created but no longer exist were either manually redeemed or expired
+    await mapConcurrently(removed, BULK_REDEEM_SEARCH_CONCURRENCY, async i => {
+      statuses[i] = (
+        await messages[i].getSuccessfulRedeem(redeemScanner)
+      ).status
+    })
+    return statuses as L1ToL2MessageStatus[]
+  }
+
+  private static resultFromTicket(
+    ticket: IndexedTicket
+  ): L1ToL2MessageWaitResult {
+    if (ticket.redeemReceipt) {
+      return {
+        l2TxReceipt: ticket.redeemReceipt,
+        status: L1ToL2MessageStatus.REDEEMED,
+      }
+    }
+    // closed without a successful redeem, so it was cancelled or expired
+    if (ticket.closed) return { status: L1ToL2MessageStatus.EXPIRED }
+    return { status: L1ToL2MessageStatus.FUNDS_DEPOSITED_ON_L2 }
+  }
+
+  private async findSuccessfulRedeem(
+    redeemScanner?: RetryableRedeemScanner
+  ): Promise<L1ToL2MessageWaitResult> {
+    if (redeemScanner) {
+      await redeemScanner.sync()
+      const ticket = redeemScanner.getTicket(this.retryableCreationId)
+      if (ticket) return L1ToL2MessageReader.resultFromTicket(ticket)
+    }
+
     const creationReceipt = await this.getRetryableCreationReceipt()
 
     if (!isDefined(creationReceipt)) {
@@ -330,83 +547,130 @@ export class L1ToL2MessageReader extends L1ToL2Message {
     // so the retryable was either successfully redeemed, or it expired
 
     // the auto redeem didnt exist or wasnt successful, look for a later manual redeem
-    // to do this we need to filter through the whole lifetime of the ticket looking
-    // for relevant redeem scheduled events
-    let increment = 1000
-    let fromBlock = await this.l2Provider.getBlock(creationReceipt.blockNumber)
-    let timeout = fromBlock.timestamp + l2Network.retryableLifetimeSeconds
-    const queriedRange: { from: number; to: number }[] = []
-    const maxBlock = await this.l2Provider.getBlockNumber()
-    while (fromBlock.number < maxBlock) {
-      const toBlockNumber = Math.min(fromBlock.number + increment, maxBlock)
-
-      // using fromBlock.number would lead to 1 block overlap
-      // not fixing it here to keep the code simple
-      const outerBlockRange = { from: fromBlock.number, to: toBlockNumber }
-      queriedRange.push(outerBlockRange)
-      const redeemEvents = await eventFetcher.getEvents(
-        ArbRetryableTx__factory,
-        contract => contract.filters.RedeemScheduled(this.retryableCreationId),
-        {
-          fromBlock: outerBlockRange.from,
-          toBlock: outerBlockRange.to,
-          address: ARB_RETRYABLE_TX_ADDRESS,
-        }
-      )
-      const successfulRedeem = (
-        await Promise.all(
-          redeemEvents.map(e =>
-            this.l2Provider.getTransactionReceipt(e.event.retryTxHash)
+    // to do this we need to filter through the lifetime of the ticket looking for
+    // relevant redeem scheduled and lifetime extended events
+    const l2Network = await getL2Network(this.chainId)
+    return await this.searchForRedeem(
+      creationReceipt.blockNumber,
+      l2Network.retryableLifetimeSeconds
+    )
+  }
+
+  /**
+   * Search the lifetime of a ticket, that is known to no longer exist, for its successful
+   * redeem. The lifetime is split into windows of about a day, a bounded number of which
+   * are searched at once, and results are consumed in block order so that the search stops
+   * at the first successful redeem or once a window ends after the (extended) timeout.
+   * Windows still in flight when the search stops skip their remaining lookups.
+   */
+  private async searchForRedeem(
+    creationBlockNumber: number,
+    retryableLifetimeSeconds: number
+  ): Promise<L1ToL2MessageWaitResult> {
+    const eventFetcher = new EventFetcher(this.l2Provider)
+    const [creationTimestamp, latestBlock] = await Promise.all([
+      this.getCreationBlockTimestamp(creationBlockNumber),
+      HeadTracker.forProvider(this.l2Provider).getHead(),
+    ])
+    let timeout = creationTimestamp + retryableLifetimeSeconds
+
+    // size the windows to cover ~ 1 day, based on the average block time since creation
+    const elapsedSeconds = latestBlock.timestamp - creationTimestamp
+    const windowSize =
+      elapsedSeconds > 0
+        ? Math.max(
+            MIN_REDEEM_SEARCH_WINDOW,
+            Math.ceil(
+              ((latestBlock.number - creationBlockNumber) * 86400) /
+                elapsedSeconds
+            )
           )
-        )
-      ).filter(r => isDefined(r) && r.status === 1)
+        : MIN_REDEEM_SEARCH_WINDOW
+
+    let stopped = false
+    const searchWindow = async (fromBlock: number, toBlock: number) => {
+      const [events, toBlockTimestamp] = await Promise.all([
+        eventFetcher.getEvents(
+          ArbRetryableTx__factory,
+          t =>
+            ({
+              topics: [
+                [
+                  t.interface.getEventTopic('RedeemScheduled'),
+                  t.interface.getEventTopic('LifetimeExtended'),
+                ],
+                this.retryableCreationId,
+              ],
+            } as TypedEventFilter<
+              RedeemScheduledEvent | LifetimeExtendedEvent
+            >),
+          { fromBlock, toBlock, address: ARB_RETRYABLE_TX_ADDRESS }
+        ),
+        this.l2Provider.getBlock(toBlock).then(b => b.timestamp),
+      ])
+      // the result of a window is only used if the search is still running
+      if (stopped) return undefined
+      const receipts = await Promise.all(
+        events
+          .filter(e => e.name === 'RedeemScheduled')
+          .map(e =>
+            getTransactionReceipt(
+              this.l2Provider,
+              decodeRedeemScheduledEvent(e).retryTxHash
+            )
+          )
+      )
+      return {
+        successfulRedeem: receipts.filter(r => isDefined(r) && r.status === 1),
+        newTimeouts: events
+          .filter(e => e.name === 'LifetimeExtended')
+          .map(e =>
+            (e.event as EventArgs<LifetimeExtendedEvent>).newTimeout.toNumber()
+          ),
+        toBlockTimestamp,
+      }
+    }
 
-      if (successfulRedeem.length > 1)
-        throw new ArbSdkError(
-          `Unexpected number of successful redeems. Expected only one redeem for ticket ${this.retryableCreationId}, but found ${successfulRedeem.length}.`
-        )
-      if (successfulRedeem.length == 1)
-        return {
-          l2TxReceipt: successfulRedeem[0],
-          status: L1ToL2MessageStatus.REDEEMED,
-        }
-
-      const toBlock = await this.l2Provider.getBlock(toBlockNumber)
-      if (toBlock.timestamp > timeout) {
-        // Check for LifetimeExtended event
-        while (queriedRange.length > 0) {
-          const blockRange = queriedRange.shift()
-          const keepaliveEvents = await eventFetcher.getEvents(
-            ArbRetryableTx__factory,
-            contract =>
-              contract.filters.LifetimeExtended(this.retryableCreationId),
-            {
-              fromBlock: blockRange!.from,
-              toBlock: blockRange!.to,
-              address: ARB_RETRYABLE_TX_ADDRESS,
-            }
+    const windows: ReturnType<typeof searchWindow>[] = []
+    let nextFromBlock = creationBlockNumber
+    const startNextWindow = () => {
+      if (nextFromBlock > latestBlock.number) return
+      const toBlock = Math.min(
+        nextFromBlock + windowSize - 1,
+        latestBlock.number
+      )
+      const window = searchWindow(nextFromBlock, toBlock)
+      // windows still in flight when the search stops are never awaited
+      window.catch(() => undefined)
+      windows.push(window)
+      nextFromBlock = toBlock + 1
+    }
+    for (let i = 0; i < REDEEM_SEARCH_CONCURRENCY; i++) startNextWindow()
+
+    try {
+      while (windows.length > 0) {
+        // windows only skip their lookups once the search has stopped
+        const result = (await windows.shift())!
+        if (result.successfulRedeem.length > 1)
+          throw new ArbSdkError(
+            `Unexpected number of successful redeems. Expected only one redeem for ticket ${this.retryableCreationId}, but found ${result.successfulRedeem.length}.`
           )
-          if (keepaliveEvents.length > 0) {
-            timeout = keepaliveEvents
-              .map(e => e.event.newTimeout.toNumber())
-              .sort()
-              .reverse()[0]
-            break
+        if (result.successfulRedeem.length == 1)
+          return {
+            l2TxReceipt: result.successfulRedeem[0],
+            status: L1ToL2MessageStatus.REDEEMED,
           }
-        }
+
+        // the lifetime can only be extended before the timeout, and windows are
+        // processed in order, so any extension has been seen by the time the timeout passes
+        timeout = Math.max(timeout, ...result.newTimeouts)
         // the retryable no longer exists, but we've searched beyond the timeout
         // so it must have expired
-        if (toBlock.timestamp > timeout) break
-        // It is possible to have another keepalive in the last range as it might include block after previous timeout
-        while (queriedRange.length > 1) queriedRange.shift()
+        if (result.toBlockTimestamp > timeout) break
+        startNextWindow()
       }
-      const processedSeconds = toBlock.timestamp - fromBlock.timestamp
-      if (processedSeconds != 0) {
-        // find the increment that cover ~ 1 day
-        increment = Math.ceil((increment * 86400) / processedSeconds)
-      }
-
-      fromBlock = toBlock
+    } finally {
+      stopped = true
     }
 
     // we know from earlier that the retryable no longer exists, so if we havent found the redemption
@@ -414,6 +678,17 @@ export class L1ToL2MessageReader extends L1ToL2Message {
     return { status: L1ToL2MessageStatus.EXPIRED }
   }
 
+  private async getCreationBlockTimestamp(
+    creationBlockNumber: number
+  ): Promise<number> {
+    if (this.creationBlockTimestamp === undefined) {
+      this.creationBlockTimestamp = (
+        await this.l2Provider.getBlock(creationBlockNumber)
+      ).timestamp
+    }
+    return this.creationBlockTimestamp
+  }
+
   /**
    * Has this message expired. Once expired the retryable ticket can no longer be redeemed.
    * @deprecated Will be removed in v3.0.0
@@ -427,7 +702,7 @@ export class L1ToL2MessageReader extends L1ToL2Message {
     try {
       const timeoutTimestamp = await this.getTimeout()
       const currentTimestamp = BigNumber.from(
-        (await this.l2Provider.getBlock('latest')).timestamp
+        await HeadTracker.forProvider(this.l2Provider).getTimestamp()
       )
 
       // timeoutTimestamp returns the timestamp at which the retryable ticket expires
@@ -438,8 +713,13 @@ export class L1ToL2MessageReader extends L1ToL2Message {
     }
   }
 
-  public async status(): Promise<L1ToL2MessageStatus> {
-    return (await this.getSuccessfulRedeem()).status
+  /**
+   * @param redeemScanner Optional index of redeems to resolve the status from, see getSuccessfulRedeem
+   */
+  public async status(
+    redeemScanner?: RetryableRedeemScanner
+  ): Promise<L1ToL2MessageStatus> {
+    return (await this.getSuccessfulRedeem(redeemScanner)).status
   }
 
   /**
@@ -488,7 +768,8 @@ export class L1ToL2MessageReader extends L1ToL2Message {
    * @returns
    */
   public static async getLifetime(l2Provider: Provider): Promise<BigNumber> {
-    const arbRetryableTx = ArbRetryableTx__factory.connect(
+    const arbRetryableTx = connectContract(
+      ArbRetryableTx__factory,
       ARB_RETRYABLE_TX_ADDRESS,
       l2Provider
     )
@@ -500,7 +781,8 @@ export class L1ToL2MessageReader extends L1ToL2Message {
    * @returns
    */
   public async getTimeout(): Promise<BigNumber> {
-    const arbRetryableTx = ArbRetryableTx__factory.connect(
+    const arbRetryableTx = connectContract(
+      ArbRetryableTx__factory,
       ARB_RETRYABLE_TX_ADDRESS,
       this.l2Provider
     )
@@ -513,7 +795,8 @@ export class L1ToL2MessageReader extends L1ToL2Message {
    * @returns
    */
   public getBeneficiary(): Promise<string> {
-    const arbRetryableTx = ArbRetryableTx__factory.connect(
+    const arbRetryableTx = connectContract(
+      ArbRetryableTx__factory,
       ARB_RETRYABLE_TX_ADDRESS,
       this.l2Provider
     )
@@ -600,7 +883,8 @@ export class L1ToL2MessageReaderClassic {
     }
 
     const l2DerivedHash = this.calculateL2DerivedHash(this.retryableCreationId)
-    const l2TxReceipt = await this.l2Provider.getTransactionReceipt(
+    const l2TxReceipt = await getTransactionReceipt(
+      this.l2Provider,
       l2DerivedHash
     )
 
@@ -640,7 +924,8 @@ export class L1ToL2MessageWriter extends L1ToL2MessageReader {
   public async redeem(overrides?: Overrides): Promise<RedeemTransaction> {
     const status = await this.status()
     if (status === L1ToL2MessageStatus.FUNDS_DEPOSITED_ON_L2) {
-      const arbRetryableTx = ArbRetryableTx__factory.connect(
+      const arbRetryableTx = connectContract(
+        ArbRetryableTx__factory,
         ARB_RETRYABLE_TX_ADDRESS,
         this.l2Signer
       )
@@ -671,7 +956,8 @@ export class L1ToL2MessageWriter extends L1ToL2MessageReader {
   public async cancel(overrides?: Overrides): Promise<ContractTransaction> {
     const status = await this.status()
     if (status === L1ToL2MessageStatus.FUNDS_DEPOSITED_ON_L2) {
-      const arbRetryableTx = ArbRetryableTx__factory.connect(
+      const arbRetryableTx = connectContract(
+        ArbRetryableTx__factory,
         ARB_RETRYABLE_TX_ADDRESS,
         this.l2Signer
       )
@@ -694,7 +980,8 @@ export class L1ToL2MessageWriter extends L1ToL2MessageReader {
   public async keepAlive(overrides?: Overrides): Promise<ContractTransaction> {
     const status = await this.status()
     if (status === L1ToL2MessageStatus.FUNDS_DEPOSITED_ON_L2) {
-      const arbRetryableTx = ArbRetryableTx__factory.connect(
+      const arbRetryableTx = connectContract(
+        ArbRetryableTx__factory,
         ARB_RETRYABLE_TX_ADDRESS,
         this.l2Signer
       )
@@ -783,7 +1070,7 @@ export class EthDepositMessage {
     senderAddr: string,
     inboxMessageEventData: string
   ) {
-    const chainId = (await l2Provider.getNetwork()).chainId
+    const chainId = await SignerProviderUtils.getChainId(l2Provider)
     const { to, value } = EthDepositMessage.parseEthDepositData(
       inboxMessageEventData
     )
@@ -824,13 +1111,40 @@ export class EthDepositMessage {
   }
 
   public async status(): Promise<EthDepositStatus> {
-    const receipt = await this.l2Provider.getTransactionReceipt(
+    const receipt = await getTransactionReceipt(
+      this.l2Provider,
       this.l2DepositTxHash
     )
     if (receipt === null) return EthDepositStatus.PENDING
     else return EthDepositStatus.DEPOSITED
   }
 
+  /**
+   * Get the statuses of many eth deposits at once, the deposit receipts are fetched
+   * in JSON-RPC batches
+   * @param messages Deposits on the same L2 provider
+   * @returns Statuses in the same order as the messages
+   */
+  public static async bulkStatus(
+    messages: EthDepositMessage[]
+  ): Promise<EthDepositStatus[]> {
+    if (messages.length === 0) return []
+    const l2Provider = messages[0].l2Provider
+    if (messages.some(m => m.l2Provider !== l2Provider)) {
+      throw new ArbSdkError('All messages must use the same L2 provider.')
+    }
+
+    const receipts = await getTransactionReceipts(
+      l2Provider,
+      messages.map(m => m.l2DepositTxHash)
+    )
+    return receipts.map((receipt, i) => {
+      if (receipt === null) return EthDepositStatus.PENDING
+      messages[i].l2DepositTxReceipt = receipt
+      return EthDepositStatus.DEPOSITED
+    })
+  }
+
   public async wait(confirmations?: number, timeout?: number) {
     const l2Network = await getL2Network(this.l2ChainId)
 
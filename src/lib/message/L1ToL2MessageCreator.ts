@@ -18,6 +18,7 @@ import {
 } from '../dataEntities/transactionRequest'
 import { RetryableData } from '../dataEntities/retryableData'
 import { OmitTyped, PartialPick } from '../utils/types'
+import { getInterface } from '../utils/contractCache'
 
 type L1ToL2GasKeys =
   | 'maxSubmissionCost'
@@ -97,7 +98,7 @@ export class L1ToL2MessageCreator {
     )
 
     const l2Network = await getL2Network(l2Provider)
-    const inboxInterface = Inbox__factory.createInterface()
+    const inboxInterface = getInterface(Inbox__factory)
     const functionData = inboxInterface.encodeFunctionData(
       'createRetryableTicket',
       [
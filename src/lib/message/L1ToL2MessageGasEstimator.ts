@@ -17,6 +17,7 @@ import {
   L1ToL2MessageGasParams,
   L1ToL2MessageNoGasParams,
 } from './L1ToL2MessageCreator'
+import { connectContract } from '../utils/contractCache'
 
 /**
  * The default amount to increase the maximum submission cost. Submission cost is calculated
@@ -126,7 +127,11 @@ export class L1ToL2MessageGasEstimator {
     const defaultedOptions = this.applySubmissionPriceDefaults(options)
 
     const network = await getL2Network(this.l2Provider)
-    const inbox = Inbox__factory.connect(network.ethBridge.inbox, l1Provider)
+    const inbox = connectContract(
+      Inbox__factory,
+      network.ethBridge.inbox,
+      l1Provider
+    )
 
     return this.percentIncrease(
       defaultedOptions.base ||
@@ -153,7 +158,8 @@ export class L1ToL2MessageGasEstimator {
     }: L1ToL2MessageNoGasParams,
     senderDeposit: BigNumber = utils.parseEther('1').add(l2CallValue)
   ): Promise<L1ToL2MessageGasParams['gasLimit']> {
-    const nodeInterface = NodeInterface__factory.connect(
+    const nodeInterface = connectContract(
+      NodeInterface__factory,
       NODE_INTERFACE_ADDRESS,
       this.l2Provider
     )
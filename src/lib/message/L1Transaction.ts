@@ -38,11 +38,16 @@ import {
   SignerOrProvider,
 } from '../dataEntities/signerOrProvider'
 import { ArbSdkError } from '../dataEntities/errors'
-import { Inbox__factory } from '../abi/factories/Inbox__factory'
 import { InboxMessageDeliveredEvent } from '../abi/Inbox'
 import { InboxMessageKind } from '../dataEntities/message'
-import { Bridge__factory } from '../abi/factories/Bridge__factory'
 import { MessageDeliveredEvent } from '../abi/Bridge'
+import {
+  decodeInboxMessageDeliveredEvent,
+  decodeMessageDeliveredEvent,
+  INBOX_MESSAGE_DELIVERED_TOPIC,
+  MESSAGE_DELIVERED_TOPIC,
+} from '../abi/fastCodecs'
+import { toBigNumber } from '../utils/fastAbi'
 import { EventArgs, parseTypedLogs } from '../dataEntities/event'
 import { isDefined } from '../utils/lib'
 import { SubmitRetryableMessageDataParser } from './messageDataParser'
@@ -115,7 +120,17 @@ export class L1TransactionReceipt implements TransactionReceipt {
    * @returns
    */
   public getMessageDeliveredEvents(): EventArgs<MessageDeliveredEvent>[] {
-    return parseTypedLogs(Bridge__factory, this.logs, 'MessageDelivered')
+    return this.logs
+      .filter(l => l.topics[0]?.toLowerCase() === MESSAGE_DELIVERED_TOPIC)
+      .map(l => {
+        const args = decodeMessageDeliveredEvent(l)
+        return {
+          ...args,
+          messageIndex: toBigNumber(args.messageIndex),
+          baseFeeL1: toBigNumber(args.baseFeeL1),
+          timestamp: toBigNumber(args.timestamp),
+        }
+      })
   }
 
   /**
@@ -123,11 +138,14 @@ export class L1TransactionReceipt implements TransactionReceipt {
    * @returns
    */
   public getInboxMessageDeliveredEvents() {
-    return parseTypedLogs(
-      Inbox__factory,
-      this.logs,
-      'InboxMessageDelivered(uint256,bytes)'
-    )
+    return this.logs
+      .filter(
+        l => l.topics[0]?.toLowerCase() === INBOX_MESSAGE_DELIVERED_TOPIC
+      )
+      .map(l => {
+        const args = decodeInboxMessageDeliveredEvent(l)
+        return { ...args, messageNum: toBigNumber(args.messageNum) }
+      })
   }
 
   /**
@@ -37,6 +37,7 @@ import { EventArgs } from '../dataEntities/event'
 import { L2ToL1MessageStatus } from '../dataEntities/message'
 import { getL2Network } from '../dataEntities/networks'
 import { ArbSdkError } from '../dataEntities/errors'
+import { EventPage, EventStreamOptions } from '../utils/eventFetcher'
 
 export type L2ToL1TransactionEvent =
   | EventArgs<ClassicL2ToL1TransactionEvent>
@@ -98,6 +99,100 @@ export class L2ToL1Message {
     hash?: BigNumber,
     indexInBatch?: BigNumber
   ): Promise<(L2ToL1TransactionEvent & { transactionHash: string })[]> {
+    const { classicFilter, nitroFilter } = await this.splitClassicNitroRange(
+      l2Provider,
+      filter
+    )
+
+    const logQueries = []
+    if (classicFilter) {
+      logQueries.push(
+        classic.L2ToL1MessageClassic.getL2ToL1Events(
+          l2Provider,
+          classicFilter,
+          position,
+          destination,
+          hash,
+          indexInBatch
+        )
+      )
+    }
+
+    if (nitroFilter) {
+      logQueries.push(
+        nitro.L2ToL1MessageNitro.getL2ToL1Events(
+          l2Provider,
+          nitroFilter,
+          position,
+          destination,
+          hash
+        )
+      )
+    }
+
+    return (await Promise.all(logQueries)).flat(1)
+  }
+
+  /**
+   * Stream event logs for L2ToL1 transactions page by page, classic events first then nitro events.
+   * Each page carries a cursor that can be passed back in the options to resume the stream.
+   * See getL2ToL1Events for a description of the filter parameters.
+   * @param l2Provider
+   * @param filter Block range filter
+   * @param position
+   * @param destination
+   * @param hash
+   * @param indexInBatch
+   * @param options Paging options and an optional cursor to resume from
+   */
+  public static async *streamL2ToL1Events(
+    l2Provider: Provider,
+    filter: { fromBlock: BlockTag; toBlock: BlockTag },
+    position?: BigNumber,
+    destination?: string,
+    hash?: BigNumber,
+    indexInBatch?: BigNumber,
+    options?: EventStreamOptions
+  ): AsyncGenerator<
+    EventPage<L2ToL1TransactionEvent & { transactionHash: string }>
+  > {
+    const { classicFilter, nitroFilter } = await this.splitClassicNitroRange(
+      l2Provider,
+      filter
+    )
+
+    if (classicFilter) {
+      yield* classic.L2ToL1MessageClassic.streamL2ToL1Events(
+        l2Provider,
+        classicFilter,
+        position,
+        destination,
+        hash,
+        indexInBatch,
+        options
+      )
+    }
+
+    if (nitroFilter) {
+      yield* nitro.L2ToL1MessageNitro.streamL2ToL1Events(
+        l2Provider,
+        nitroFilter,
+        position,
+        destination,
+        hash,
+        options
+      )
+    }
+  }
+
+  /**
+   * Split a block range into the classic and nitro parts, either of which is undefined
+   * if the range does not cover it
+   */
+  private static async splitClassicNitroRange(
+    l2Provider: Provider,
+    filter: { fromBlock: BlockTag; toBlock: BlockTag }
+  ) {
     const l2Network = await getL2Network(l2Provider)
 
     const inClassicRange = (blockTag: BlockTag, nitroGenBlock: number) => {
@@ -144,37 +239,19 @@ export class L2ToL1Message {
       fromBlock: inClassicRange(filter.fromBlock, l2Network.nitroGenesisBlock),
       toBlock: inClassicRange(filter.toBlock, l2Network.nitroGenesisBlock),
     }
-    const logQueries = []
-    if (classicFilter.fromBlock !== classicFilter.toBlock) {
-      logQueries.push(
-        classic.L2ToL1MessageClassic.getL2ToL1Events(
-          l2Provider,
-          classicFilter,
-          position,
-          destination,
-          hash,
-          indexInBatch
-        )
-      )
-    }
-
     const nitroFilter = {
       fromBlock: inNitroRange(filter.fromBlock, l2Network.nitroGenesisBlock),
       toBlock: inNitroRange(filter.toBlock, l2Network.nitroGenesisBlock),
     }
-    if (nitroFilter.fromBlock !== nitroFilter.toBlock) {
-      logQueries.push(
-        nitro.L2ToL1MessageNitro.getL2ToL1Events(
-          l2Provider,
-          nitroFilter,
-          position,
-          destination,
-          hash
-        )
-      )
-    }
 
-    return (await Promise.all(logQueries)).flat(1)
+    return {
+      classicFilter:
+        classicFilter.fromBlock !== classicFilter.toBlock
+          ? classicFilter
+          : undefined,
+      nitroFilter:
+        nitroFilter.fromBlock !== nitroFilter.toBlock ? nitroFilter : undefined,
+    }
   }
 }
 
@@ -225,18 +302,25 @@ export class L2ToL1MessageReader extends L2ToL1Message {
    * WARNING: Outbox entries are only created when the corresponding node is confirmed. Which
    * can take 1 week+, so waiting here could be a very long operation.
    * @param retryDelay
+   * @param signal Rejects the wait when aborted
    * @returns
    */
   public async waitUntilReadyToExecute(
     l2Provider: Provider,
-    retryDelay = 500
+    retryDelay = 500,
+    signal?: AbortSignal
   ): Promise<void> {
     if (this.nitroReader)
-      return this.nitroReader.waitUntilReadyToExecute(l2Provider, retryDelay)
+      return this.nitroReader.waitUntilReadyToExecute(
+        l2Provider,
+        retryDelay,
+        signal
+      )
     else
       return this.classicReader!.waitUntilOutboxEntryCreated(
         l2Provider,
-        retryDelay
+        retryDelay,
+        signal
       )
   }
 
@@ -0,0 +1,319 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { Provider } from '@ethersproject/abstract-provider'
+import { Signer } from '@ethersproject/abstract-signer'
+import { BigNumber } from '@ethersproject/bignumber'
+import { ContractTransaction, Overrides } from 'ethers'
+
+import { Outbox__factory } from '../abi/factories/Outbox__factory'
+import { Multicall2__factory } from '../abi/factories/Multicall2__factory'
+import { getL2Network, L2Network } from '../dataEntities/networks'
+import { ArbSdkError, MissingProviderArbSdkError } from '../dataEntities/errors'
+import { L2ToL1MessageStatus } from '../dataEntities/message'
+import { SignerProviderUtils } from '../dataEntities/signerOrProvider'
+import { mapConcurrently } from '../utils/lib'
+import { L2ToL1MessageReaderNitro } from './L2ToL1MessageNitro'
+import { connectContract, getInterface } from '../utils/contractCache'
+
+export type L2ToL1BatchExecuteOptions = {
+  /**
+   * How to submit the executions:
+   * - 'pipelined' sends one Outbox.executeTransaction per message with consecutive nonces,
+   * without waiting for earlier transactions to be mined
+   * - 'multicall' groups the executions into Multicall2.tryAggregate transactions, each
+   * capped at maxGasPerTransaction, and waits for them to be mined
+   * Defaults to 'pipelined'
+   *
+   * In multicall mode Outbox.executeTransaction is called by the multicall contract, so
+   * msg.sender of the execution is the multicall rather than the signer. The Outbox does not
+   * check its caller, and message destinations are called by the Outbox in both modes, but
+   * the gas is estimated with the multicall as the sender so that any execution that would
+   * fail when called by it is reported in its result rather than sent.
+   */
+  mode?: 'pipelined' | 'multicall'
+  /**
+   * Max estimated gas of a single multicall transaction. Defaults to 10m
+   */
+  maxGasPerTransaction?: number
+  /**
+   * Overrides for every transaction sent, the nonce is managed by the executor
+   */
+  overrides?: Overrides
+}
+
+/**
+ * The outcome of executing a single message in a batch
+ */
+export type L2ToL1BatchExecuteResult = {
+  message: L2ToL1MessageReaderNitro
+  /**
+   * Status of the message before the batch was executed
+   */
+  status: L2ToL1MessageStatus
+  /**
+   * The transaction that executed the message. Undefined if it was not
+   * confirmed, already executed, or failed before being sent
+   */
+  transaction?: ContractTransaction
+  /**
+   * Set if the message could not be executed, other messages in the batch are unaffected
+   */
+  error?: Error
+}
+
+const DEFAULT_MAX_GAS_PER_TRANSACTION = 10000000
+// max number of gas estimates in flight at once
+const ESTIMATE_CONCURRENCY = 8
+
+/**
+ * Executes many confirmed nitro L2->L1 messages. Statuses are checked in one pass,
+ * proofs are fetched in bulk, and the executions are then submitted either as
+ * nonce pipelined transactions or as gas capped multicall transactions.
+ * A failure executing one message is reported in its result and does not stop the others.
+ */
+export class L2ToL1MessageBatchExecutor {
+  /**
+   * @param l1Signer Signer that submits the executions, must be connected to an L1 provider
+   * @param l2Provider
+   */
+  public constructor(
+    public readonly l1Signer: Signer,
+    public readonly l2Provider: Provider
+  ) {
+    if (!SignerProviderUtils.signerHasProvider(l1Signer)) {
+      throw new MissingProviderArbSdkError('l1Signer')
+    }
+  }
+
+  /**
+   * Execute every confirmed message in the batch. Unconfirmed and already executed
+   * messages are skipped and reported with their status.
+   * @param messages
+   * @param options
+   * @returns A result for each message, in the same order as the messages
+   */
+  public async execute(
+    messages: L2ToL1MessageReaderNitro[],
+    options?: L2ToL1BatchExecuteOptions
+  ): Promise<L2ToL1BatchExecuteResult[]> {
+    const l2Network = await getL2Network(this.l2Provider)
+    const statuses = await L2ToL1MessageReaderNitro.getStatuses(
+      this.l2Provider,
+      messages
+    )
+    const results: L2ToL1BatchExecuteResult[] = messages.map((message, i) => ({
+      message,
+      status: statuses[i],
+    }))
+
+    const executable = results.filter(
+      r => r.status === L2ToL1MessageStatus.CONFIRMED
+    )
+    if (executable.length === 0) return results
+
+    const proofs = await this.getProofs(executable)
+    const ready = executable.filter(r => !r.error)
+    if (options?.mode === 'multicall') {
+      await this.executeWithMulticall(l2Network, ready, proofs, options)
+    } else {
+      await this.executePipelined(l2Network, ready, proofs, options)
+    }
+    return results
+  }
+
+  /**
+   * Fetch the proofs in bulk, falling back to fetching them one by one if the bulk fetch
+   * fails so that a single bad message is only reported against itself
+   */
+  private async getProofs(
+    results: L2ToL1BatchExecuteResult[]
+  ): Promise<Map<L2ToL1BatchExecuteResult, string[]>> {
+    const proofs = new Map<L2ToL1BatchExecuteResult, string[]>()
+    try {
+      const bulk = await L2ToL1MessageReaderNitro.getOutboxProofs(
+        this.l2Provider,
+        results.map(r => r.message)
+      )
+      results.forEach((r, i) => proofs.set(r, bulk[i]))
+    } catch (err) {
+      for (const r of results) {
+        try {
+          proofs.set(r, await r.message.getOutboxProof(this.l2Provider))
+        } catch (proofErr) {
+          r.error = proofErr as Error
+        }
+      }
+    }
+    return proofs
+  }
+
+  private encodeExecute(
+    result: L2ToL1BatchExecuteResult,
+    proof: string[]
+  ): string {
+    const event = result.message.event
+    return getInterface(Outbox__factory).encodeFunctionData(
+      'executeTransaction',
+      [
+        proof,
+        event.position,
+        event.caller,
+        event.destination,
+        event.arbBlockNum,
+        event.ethBlockNum,
+        event.timestamp,
+        event.callvalue,
+        event.data,
+      ]
+    )
+  }
+
+  private async executePipelined(
+    l2Network: L2Network,
+    results: L2ToL1BatchExecuteResult[],
+    proofs: Map<L2ToL1BatchExecuteResult, string[]>,
+    options?: L2ToL1BatchExecuteOptions
+  ): Promise<void> {
+    const outbox = connectContract(
+      Outbox__factory,
+      l2Network.ethBridge.outbox,
+      this.l1Signer
+    )
+    let nonce = await this.l1Signer.getTransactionCount('pending')
+    for (const result of results) {
+      const event = result.message.event
+      try {
+        result.transaction = await outbox.executeTransaction(
+          proofs.get(result)!,
+          event.position,
+          event.caller,
+          event.destination,
+          event.arbBlockNum,
+          event.ethBlockNum,
+          event.timestamp,
+          event.callvalue,
+          event.data,
+          { ...options?.overrides, nonce }
+        )
+        nonce++
+      } catch (err) {
+        result.error = err as Error
+        // the nonce is normally unused if sending failed, but re-read it in case
+        // the transaction reached the mempool before the error
+        nonce = await this.l1Signer.getTransactionCount('pending')
+      }
+    }
+  }
+
+  private async executeWithMulticall(
+    l2Network: L2Network,
+    results: L2ToL1BatchExecuteResult[],
+    proofs: Map<L2ToL1BatchExecuteResult, string[]>,
+    options?: L2ToL1BatchExecuteOptions
+  ): Promise<void> {
+    const l1Provider = this.l1Signer.provider!
+    const outboxAddress = l2Network.ethBridge.outbox
+    const multicallAddress = l2Network.tokenBridge.l1MultiCall
+    const calls = results.map(r => ({
+      result: r,
+      target: outboxAddress,
+      callData: this.encodeExecute(r, proofs.get(r)!),
+    }))
+
+    // messages that fail gas estimation would revert, so report them rather than send them
+    const estimates = await mapConcurrently(
+      calls,
+      ESTIMATE_CONCURRENCY,
+      async c => {
+        try {
+          // estimate as the multicall, which is the caller of the executions
+          return await l1Provider.estimateGas({
+            from: multicallAddress,
+            to: c.target,
+            data: c.callData,
+          })
+        } catch (err) {
+          c.result.error = err as Error
+          return undefined
+        }
+      }
+    )
+
+    const maxGas =
+      options?.maxGasPerTransaction || DEFAULT_MAX_GAS_PER_TRANSACTION
+    const groups: { calls: typeof calls; gas: BigNumber }[] = []
+    calls.forEach((call, i) => {
+      const gas = estimates[i]
+      if (!gas) return
+      const current = groups[groups.length - 1]
+      if (current && current.gas.add(gas).lte(maxGas)) {
+        current.calls.push(call)
+        current.gas = current.gas.add(gas)
+      } else groups.push({ calls: [call], gas })
+    })
+
+    const multicall = connectContract(
+      Multicall2__factory,
+      multicallAddress,
+      this.l1Signer
+    )
+    const outbox = connectContract(Outbox__factory, outboxAddress, l1Provider)
+    let nonce = await this.l1Signer.getTransactionCount('pending')
+    const sent: Promise<void>[] = []
+    for (const group of groups) {
+      let transaction: ContractTransaction
+      try {
+        transaction = await multicall.tryAggregate(
+          false,
+          group.calls.map(c => ({ target: c.target, callData: c.callData })),
+          { ...options?.overrides, nonce }
+        )
+        nonce++
+      } catch (err) {
+        for (const c of group.calls) c.result.error = err as Error
+        nonce = await this.l1Signer.getTransactionCount('pending')
+        continue
+      }
+
+      // tryAggregate does not revert when a single execution fails, so check which
+      // messages were actually executed once the transaction is mined
+      sent.push(
+        (async () => {
+          try {
+            await transaction.wait()
+            for (const c of group.calls) {
+              c.result.transaction = transaction
+              const spent = await outbox.callStatic.isSpent(
+                c.result.message.event.position
+              )
+              if (!spent) {
+                c.result.error = new ArbSdkError(
+                  'Message was not executed by the multicall transaction.'
+                )
+              }
+            }
+          } catch (err) {
+            for (const c of group.calls) c.result.error = err as Error
+          }
+        })()
+      )
+    }
+    await Promise.all(sent)
+  }
+}
@@ -31,7 +31,11 @@ import { Outbox__factory } from '../abi/classic/factories/Outbox__factory'
 import { NodeInterface__factory } from '../abi/factories/NodeInterface__factory'
 import { L2ToL1TransactionEvent } from '../abi/ArbSys'
 import { ContractTransaction, Overrides } from 'ethers'
-import { EventFetcher } from '../utils/eventFetcher'
+import {
+  EventFetcher,
+  EventPage,
+  EventStreamOptions,
+} from '../utils/eventFetcher'
 import {
   SignerProviderUtils,
   SignerOrProvider,
@@ -41,6 +45,7 @@ import { ArbSdkError } from '../dataEntities/errors'
 import { EventArgs } from '../dataEntities/event'
 import { L2ToL1MessageStatus } from '../dataEntities/message'
 import { getL2Network } from '../dataEntities/networks'
+import { connectContract } from '../utils/contractCache'
 
 export interface MessageBatchProofInfo {
   /**
@@ -166,6 +171,42 @@ export class L2ToL1MessageClassic {
       } else return []
     } else return events
   }
+
+  /**
+   * Stream the classic L2ToL1Transaction events page by page, see EventFetcher.streamEvents
+   * @param l2Provider
+   * @param filter Block range filter
+   * @param batchNumber
+   * @param destination
+   * @param uniqueId
+   * @param indexInBatch
+   * @param options Paging options and an optional cursor to resume from
+   */
+  public static async *streamL2ToL1Events(
+    l2Provider: Provider,
+    filter: { fromBlock: BlockTag; toBlock: BlockTag },
+    batchNumber?: BigNumber,
+    destination?: string,
+    uniqueId?: BigNumber,
+    indexInBatch?: BigNumber,
+    options?: EventStreamOptions
+  ): AsyncGenerator<
+    EventPage<EventArgs<L2ToL1TransactionEvent> & { transactionHash: string }>
+  > {
+    const eventFetcher = new EventFetcher(l2Provider)
+    for await (const page of eventFetcher.streamEvents(
+      ArbSys__factory,
+      t =>
+        t.filters.L2ToL1Transaction(null, destination, uniqueId, batchNumber),
+      { ...filter, address: ARB_SYS_ADDRESS },
+      options
+    )) {
+      const events = page.events
+        .map(l => ({ ...l.event, transactionHash: l.transactionHash }))
+        .filter(e => !indexInBatch || e.indexInBatch.eq(indexInBatch))
+      yield { events, cursor: page.cursor }
+    }
+  }
 }
 
 /**
@@ -228,7 +269,11 @@ export class L2ToL1MessageReaderClassic extends L2ToL1MessageClassic {
       this.batchNumber.toNumber()
     )
 
-    const outbox = Outbox__factory.connect(outboxAddress, this.l1Provider)
+    const outbox = connectContract(
+      Outbox__factory,
+      outboxAddress,
+      this.l1Provider
+    )
     return await outbox.outboxEntryExists(this.batchNumber)
   }
 
@@ -237,7 +282,8 @@ export class L2ToL1MessageReaderClassic extends L2ToL1MessageClassic {
     batchNumber: BigNumber,
     indexInBatch: BigNumber
   ): Promise<MessageBatchProofInfo | null> {
-    const nodeInterface = NodeInterface__factory.connect(
+    const nodeInterface = connectContract(
+      NodeInterface__factory,
       NODE_INTERFACE_ADDRESS,
       l2Provider
     )
@@ -288,7 +334,11 @@ export class L2ToL1MessageReaderClassic extends L2ToL1MessageClassic {
       this.batchNumber.toNumber()
     )
 
-    const outbox = Outbox__factory.connect(outboxAddress, this.l1Provider)
+    const outbox = connectContract(
+      Outbox__factory,
+      outboxAddress,
+      this.l1Provider
+    )
     try {
       await outbox.callStatic.executeTransaction(
         this.batchNumber,
@@ -338,18 +388,16 @@ export class L2ToL1MessageReaderClassic extends L2ToL1MessageClassic {
    * WARNING: Outbox entries are only created when the corresponding node is confirmed. Which
    * can take 1 week+, so waiting here could be a very long operation.
    * @param retryDelay
+   * @param signal Rejects the wait when aborted
    * @returns
    */
   public async waitUntilOutboxEntryCreated(
     l2Provider: Provider,
-    retryDelay = 500
+    retryDelay = 500,
+    signal?: AbortSignal
   ): Promise<void> {
-    const exists = await this.outboxEntryExists(l2Provider)
-    if (exists) {
-      return
-    } else {
-      await wait(retryDelay)
-      await this.waitUntilOutboxEntryCreated(l2Provider, retryDelay)
+    while (!(await this.outboxEntryExists(l2Provider))) {
+      await wait(retryDelay, signal)
     }
   }
 
@@ -405,7 +453,11 @@ export class L2ToL1MessageWriterClassic extends L2ToL1MessageReaderClassic {
       l2Provider,
       this.batchNumber.toNumber()
     )
-    const outbox = Outbox__factory.connect(outboxAddress, this.l1Signer)
+    const outbox = connectContract(
+      Outbox__factory,
+      outboxAddress,
+      this.l1Signer
+    )
     // We can predict and print number of missing blocks
     // if not challenged
     return await outbox.functions.executeTransaction(
@@ -31,21 +31,29 @@ import { Outbox__factory } from '../abi/factories/Outbox__factory'
 import { NodeInterface__factory } from '../abi/factories/NodeInterface__factory'
 
 import { L2ToL1TxEvent } from '../abi/ArbSys'
+import { decodeL2ToL1TxEvent } from '../abi/fastCodecs'
 import { ContractTransaction, Overrides } from 'ethers'
-import { EventFetcher, FetchedEvent } from '../utils/eventFetcher'
+import {
+  EventFetcher,
+  EventPage,
+  EventStreamOptions,
+} from '../utils/eventFetcher'
 import { ArbSdkError } from '../dataEntities/errors'
 import {
   SignerProviderUtils,
   SignerOrProvider,
 } from '../dataEntities/signerOrProvider'
-import { wait } from '../utils/lib'
+import { mapConcurrently } from '../utils/lib'
 import { getL2Network } from '../dataEntities/networks'
-import { NodeCreatedEvent, RollupUserLogic } from '../abi/RollupUserLogic'
-import { ArbitrumProvider } from '../utils/arbProvider'
-import { ArbBlock } from '../dataEntities/rpc'
-import { JsonRpcProvider } from '@ethersproject/providers'
 import { EventArgs } from '../dataEntities/event'
 import { L2ToL1MessageStatus } from '../dataEntities/message'
+import { RollupNodeCache, RollupNodeStatus } from './RollupNodeCache'
+import { ConfirmedNodeWatcher } from './ConfirmedNodeWatcher'
+import { JsonRpcBatcher } from '../utils/jsonRpcBatcher'
+import { HeadTracker } from '../utils/headTracker'
+import { MultiCaller } from '../utils/multicall'
+import { connectContract, getInterface } from '../utils/contractCache'
+import { toBigNumber } from '../utils/fastAbi'
 
 /**
  * Conditional type for Signer or Provider. If T is of type Provider
@@ -61,6 +69,64 @@ const ASSERTION_CREATED_PADDING = 50
 // expected number of L1 blocks that it takes for a validator to confirm an L1 block after the node deadline is passed
 const ASSERTION_CONFIRMED_PADDING = 20
 
+// number of nodes probed at once when searching for the node that includes a message
+const NODE_SEARCH_WIDTH = 8
+// max number of messages processed at once by the bulk methods
+const MESSAGE_CONCURRENCY = 16
+
+/**
+ * Find the first index in [0, count) whose send count is greater than the position.
+ * Probes NODE_SEARCH_WIDTH evenly spaced indices at once, so each round narrows the range
+ * by that factor rather than by half. Send counts must be non decreasing by index.
+ * @returns Undefined if no index has a greater send count
+ */
+export const searchFirstNodeAfter = async (
+  count: number,
+  position: BigNumber,
+  getSendCount: (index: number) => Promise<BigNumber>
+): Promise<number | undefined> => {
+  let found: number | undefined
+  let left = 0
+  let right = count - 1
+  while (left <= right) {
+    const span = right - left + 1
+    const probeCount = Math.min(NODE_SEARCH_WIDTH, span)
+    // the last probe is always the right end of the range
+    const probes = Array.from(
+      { length: probeCount },
+      (_, i) => right - Math.floor((span * (probeCount - 1 - i)) / probeCount)
+    )
+    const sendCounts = await Promise.all(probes.map(getSendCount))
+    const firstGreater = sendCounts.findIndex(s => s.gt(position))
+    if (firstGreater === -1) break
+
+    found = probes[firstGreater]
+    if (firstGreater > 0) left = probes[firstGreater - 1] + 1
+    right = found - 1
+  }
+  return found
+}
+
+/**
+ * Decode the args of an L2ToL1Tx log with the fast decoder, rather than the
+ * generic ethers coders. Integers are BigNumbers, as in the typechain event args
+ */
+const decodeL2ToL1TxArgs = (log: {
+  topics: string[]
+  data: string
+}): EventArgs<L2ToL1TxEvent> => {
+  const args = decodeL2ToL1TxEvent(log)
+  return {
+    ...args,
+    hash: toBigNumber(args.hash),
+    position: toBigNumber(args.position),
+    arbBlockNum: toBigNumber(args.arbBlockNum),
+    ethBlockNum: toBigNumber(args.ethBlockNum),
+    timestamp: toBigNumber(args.timestamp),
+    callvalue: toBigNumber(args.callvalue),
+  }
+}
+
 /**
  * Base functionality for nitro L2->L1 messages
  */
@@ -94,7 +160,46 @@ export class L2ToL1MessageNitro {
         t => t.filters.L2ToL1Tx(null, destination, hash, position),
         { ...filter, address: ARB_SYS_ADDRESS }
       )
-    ).map(l => ({ ...l.event, transactionHash: l.transactionHash }))
+    ).map(l => ({
+      ...decodeL2ToL1TxArgs(l),
+      transactionHash: l.transactionHash,
+    }))
+  }
+
+  /**
+   * Stream the L2ToL1Tx events page by page, see EventFetcher.streamEvents
+   * @param l2Provider
+   * @param filter Block range filter
+   * @param position
+   * @param destination
+   * @param hash
+   * @param options Paging options and an optional cursor to resume from
+   */
+  public static async *streamL2ToL1Events(
+    l2Provider: Provider,
+    filter: { fromBlock: BlockTag; toBlock: BlockTag },
+    position?: BigNumber,
+    destination?: string,
+    hash?: BigNumber,
+    options?: EventStreamOptions
+  ): AsyncGenerator<
+    EventPage<EventArgs<L2ToL1TxEvent> & { transactionHash: string }>
+  > {
+    const eventFetcher = new EventFetcher(l2Provider)
+    for await (const page of eventFetcher.streamEvents(
+      ArbSys__factory,
+      t => t.filters.L2ToL1Tx(null, destination, hash, position),
+      { ...filter, address: ARB_SYS_ADDRESS },
+      options
+    )) {
+      yield {
+        events: page.events.map(l => ({
+          ...decodeL2ToL1TxArgs(l),
+          transactionHash: l.transactionHash,
+        })),
+        cursor: page.cursor,
+      }
+    }
   }
 }
 
@@ -119,7 +224,8 @@ export class L2ToL1MessageReaderNitro extends L2ToL1MessageNitro {
     const { sendRootSize } = await this.getSendProps(l2Provider)
     if (!sendRootSize)
       throw new ArbSdkError('Node not yet created, cannot get proof.')
-    const nodeInterface = NodeInterface__factory.connect(
+    const nodeInterface = connectContract(
+      NodeInterface__factory,
       NODE_INTERFACE_ADDRESS,
       l2Provider
     )
@@ -133,12 +239,168 @@ export class L2ToL1MessageReaderNitro extends L2ToL1MessageNitro {
     return outboxProofParams.proof
   }
 
+  /**
+   * Get the outbox proofs of many messages. The latest confirmed node is only looked up once
+   * for all the messages, and the NodeInterface calls are sent as JSON-RPC batches since the
+   * NodeInterface cannot be called through a multicall contract.
+   * @param l2Provider
+   * @param messages
+   * @returns The proofs, in the same order as the messages
+   */
+  public static async getOutboxProofs(
+    l2Provider: Provider,
+    messages: L2ToL1MessageReaderNitro[]
+  ): Promise<string[][]> {
+    if (messages.length === 0) return []
+    await L2ToL1MessageReaderNitro.setConfirmedSendProps(l2Provider, messages)
+    const sendRootSizes = await mapConcurrently(
+      messages,
+      MESSAGE_CONCURRENCY,
+      async m => (await m.getSendProps(l2Provider)).sendRootSize
+    )
+
+    const constructOutboxProof = L2ToL1MessageReaderNitro.outboxProofCaller(
+      l2Provider
+    )
+    const proofs = new Map<string, Promise<string[]>>()
+    return await Promise.all(
+      messages.map(async (m, i) => {
+        const sendRootSize = sendRootSizes[i]
+        if (!sendRootSize)
+          throw new ArbSdkError('Node not yet created, cannot get proof.')
+
+        const size = sendRootSize.toNumber()
+        const leaf = m.event.position.toNumber()
+        const key = `${size}:${leaf}`
+        let proof = proofs.get(key)
+        if (!proof) {
+          proof = constructOutboxProof(size, leaf)
+          proofs.set(key, proof)
+        }
+        return await proof
+      })
+    )
+  }
+
+  /**
+   * Get a function that calls NodeInterface.constructOutboxProof. On JSON-RPC providers
+   * the calls are sent through the provider's shared batcher, other providers, such as
+   * FallbackProviders, call the contract directly
+   */
+  private static outboxProofCaller(
+    l2Provider: Provider
+  ): (size: number, leaf: number) => Promise<string[]> {
+    if (!JsonRpcBatcher.isSupported(l2Provider)) {
+      const nodeInterface = connectContract(
+        NodeInterface__factory,
+        NODE_INTERFACE_ADDRESS,
+        l2Provider
+      )
+      return async (size, leaf) =>
+        (await nodeInterface.callStatic.constructOutboxProof(size, leaf)).proof
+    }
+
+    const nodeInterface = getInterface(NodeInterface__factory)
+    const batcher = JsonRpcBatcher.forProvider(l2Provider)
+    return async (size, leaf) => {
+      const res = await batcher.send('eth_call', [
+        {
+          to: NODE_INTERFACE_ADDRESS,
+          data: nodeInterface.encodeFunctionData('constructOutboxProof', [
+            size,
+            leaf,
+          ]),
+        },
+        'latest',
+      ])
+      return nodeInterface.decodeFunctionResult('constructOutboxProof', res)
+        .proof
+    }
+  }
+
+  /**
+   * Look up the latest confirmed node once, and use it for every message that it covers
+   */
+  protected static async setConfirmedSendProps(
+    l2Provider: Provider,
+    messages: L2ToL1MessageReaderNitro[]
+  ): Promise<void> {
+    const pending = messages.filter(m => !m.sendRootConfirmed)
+    if (pending.length === 0) return
+
+    const l2Network = await getL2Network(l2Provider)
+    const rollup = connectContract(
+      RollupUserLogic__factory,
+      l2Network.ethBridge.rollup,
+      pending[0].l1Provider
+    )
+    const confirmedNode = await RollupNodeCache.shared.getNode(
+      rollup,
+      await rollup.callStatic.latestConfirmed(),
+      l2Provider,
+      RollupNodeStatus.CONFIRMED
+    )
+    for (const m of pending) {
+      if (confirmedNode.sendCount.gt(m.event.position)) {
+        m.sendRootSize = confirmedNode.sendCount
+        m.sendRootHash = confirmedNode.sendRoot
+        m.sendRootConfirmed = true
+      }
+    }
+  }
+
+  /**
+   * Get the statuses of many messages in one pass. The latest confirmed node is only looked
+   * up once, and the executed checks for confirmed messages are batched into multicalls.
+   * @param l2Provider
+   * @param messages
+   * @returns The statuses, in the same order as the messages
+   */
+  public static async getStatuses(
+    l2Provider: Provider,
+    messages: L2ToL1MessageReaderNitro[]
+  ): Promise<L2ToL1MessageStatus[]> {
+    if (messages.length === 0) return []
+    await L2ToL1MessageReaderNitro.setConfirmedSendProps(l2Provider, messages)
+
+    const confirmed = messages.filter(m => m.sendRootConfirmed)
+    const spent = new Set<L2ToL1MessageReaderNitro>()
+    if (confirmed.length > 0) {
+      const l2Network = await getL2Network(l2Provider)
+      const multiCaller = await MultiCaller.fromProvider(
+        confirmed[0].l1Provider
+      )
+      const outboxIface = getInterface(Outbox__factory)
+      const results = await multiCaller.multiCall(
+        confirmed.map(m => ({
+          targetAddr: l2Network.ethBridge.outbox,
+          encoder: () =>
+            outboxIface.encodeFunctionData('isSpent', [m.event.position]),
+          decoder: (returnData: string) =>
+            outboxIface.decodeFunctionResult('isSpent', returnData)[0],
+        })),
+        true
+      )
+      confirmed.forEach((m, i) => {
+        if (results[i]) spent.add(m)
+      })
+    }
+
+    return messages.map(m => {
+      if (!m.sendRootConfirmed) return L2ToL1MessageStatus.UNCONFIRMED
+      return spent.has(m)
+        ? L2ToL1MessageStatus.EXECUTED
+        : L2ToL1MessageStatus.CONFIRMED
+    })
+  }
+
   /**
    * Check if this message has already been executed in the Outbox
    */
   protected async hasExecuted(l2Provider: Provider): Promise<boolean> {
     const l2Network = await getL2Network(l2Provider)
-    const outbox = Outbox__factory.connect(
+    const outbox = connectContract(
+      Outbox__factory,
       l2Network.ethBridge.outbox,
       this.l1Provider
     )
@@ -159,68 +421,12 @@ export class L2ToL1MessageReaderNitro extends L2ToL1MessageNitro {
       : L2ToL1MessageStatus.CONFIRMED
   }
 
-  private parseNodeCreatedAssertion(event: FetchedEvent<NodeCreatedEvent>) {
-    return {
-      afterState: {
-        blockHash: event.event.assertion.afterState.globalState.bytes32Vals[0],
-        sendRoot: event.event.assertion.afterState.globalState.bytes32Vals[1],
-      },
-    }
-  }
-
-  private async getBlockFromNodeLog(
-    l2Provider: JsonRpcProvider,
-    log: FetchedEvent<NodeCreatedEvent>
-  ) {
-    const parsedLog = this.parseNodeCreatedAssertion(log)
-    const arbitrumProvider = new ArbitrumProvider(l2Provider)
-    const l2Block = await arbitrumProvider.getBlock(
-      parsedLog.afterState.blockHash
-    )
-    if (!l2Block) {
-      throw new ArbSdkError(
-        `Block not found. ${parsedLog.afterState.blockHash}`
-      )
-    }
-    if (l2Block.sendRoot !== parsedLog.afterState.sendRoot) {
-      throw new ArbSdkError(
-        `L2 block send root doesn't match parsed log. ${l2Block.sendRoot} ${parsedLog.afterState.sendRoot}`
-      )
-    }
-    return l2Block
-  }
-
-  private async getBlockFromNodeNum(
-    rollup: RollupUserLogic,
-    nodeNum: BigNumber,
-    l2Provider: Provider
-  ): Promise<ArbBlock> {
-    const node = await rollup.getNode(nodeNum)
-
-    // now get the block hash and sendroot for that node
-    const eventFetcher = new EventFetcher(rollup.provider)
-    const logs = await eventFetcher.getEvents(
-      RollupUserLogic__factory,
-      t => t.filters.NodeCreated(nodeNum),
-      {
-        fromBlock: node.createdAtBlock.toNumber(),
-        toBlock: node.createdAtBlock.toNumber(),
-        address: rollup.address,
-      }
-    )
-
-    if (logs.length !== 1) throw new ArbSdkError('No NodeCreated events found')
-    return await this.getBlockFromNodeLog(
-      l2Provider as JsonRpcProvider,
-      logs[0]
-    )
-  }
-
   protected async getBatchNumber(l2Provider: Provider) {
     if (this.l1BatchNumber == undefined) {
       // findBatchContainingBlock errors if block number does not exist
       try {
-        const nodeInterface = NodeInterface__factory.connect(
+        const nodeInterface = connectContract(
+          NodeInterface__factory,
           NODE_INTERFACE_ADDRESS,
           l2Provider
         )
@@ -240,16 +446,18 @@ export class L2ToL1MessageReaderNitro extends L2ToL1MessageNitro {
     if (!this.sendRootConfirmed) {
       const l2Network = await getL2Network(l2Provider)
 
-      const rollup = RollupUserLogic__factory.connect(
+      const rollup = connectContract(
+        RollupUserLogic__factory,
         l2Network.ethBridge.rollup,
         this.l1Provider
       )
 
       const latestConfirmedNodeNum = await rollup.callStatic.latestConfirmed()
-      const l2BlockConfirmed = await this.getBlockFromNodeNum(
+      const l2BlockConfirmed = await RollupNodeCache.shared.getNode(
         rollup,
         latestConfirmedNodeNum,
-        l2Provider
+        l2Provider,
+        RollupNodeStatus.CONFIRMED
       )
 
       const sendRootSizeConfirmed = BigNumber.from(l2BlockConfirmed.sendCount)
@@ -263,10 +471,11 @@ export class L2ToL1MessageReaderNitro extends L2ToL1MessageNitro {
         if (latestNodeNum.gt(latestConfirmedNodeNum)) {
           // In rare case latestNodeNum can be equal to latestConfirmedNodeNum
           // eg immediately after an upgrade, or at genesis, or on a chain where confirmation time = 0 like AnyTrust may have
-          const l2Block = await this.getBlockFromNodeNum(
+          const l2Block = await RollupNodeCache.shared.getNode(
             rollup,
             latestNodeNum,
-            l2Provider
+            l2Provider,
+            RollupNodeStatus.UNRESOLVED
           )
 
           const sendRootSize = BigNumber.from(l2Block.sendCount)
@@ -288,12 +497,15 @@ export class L2ToL1MessageReaderNitro extends L2ToL1MessageNitro {
    * Waits until the outbox entry has been created, and will not return until it has been.
    * WARNING: Outbox entries are only created when the corresponding node is confirmed. Which
    * can take 1 week+, so waiting here could be a very long operation.
-   * @param retryDelay
+   * Waiting messages share a single poll of the rollup's latest confirmed node, see ConfirmedNodeWatcher.
+   * @param retryDelay How often to check for a newly confirmed node
+   * @param signal Rejects the wait when aborted
    * @returns
    */
   public async waitUntilReadyToExecute(
     l2Provider: Provider,
-    retryDelay = 500
+    retryDelay = 500,
+    signal?: AbortSignal
   ): Promise<void> {
     const status = await this.status(l2Provider)
     if (
@@ -301,10 +513,19 @@ export class L2ToL1MessageReaderNitro extends L2ToL1MessageNitro {
       status === L2ToL1MessageStatus.EXECUTED
     ) {
       return
-    } else {
-      await wait(retryDelay)
-      await this.waitUntilReadyToExecute(l2Provider, retryDelay)
     }
+
+    const l2Network = await getL2Network(l2Provider)
+    const rollup = connectContract(
+      RollupUserLogic__factory,
+      l2Network.ethBridge.rollup,
+      this.l1Provider
+    )
+    await ConfirmedNodeWatcher.forRollup(rollup, l2Provider).waitForPosition(
+      this.event.position,
+      retryDelay,
+      signal
+    )
   }
 
   /**
@@ -316,84 +537,143 @@ export class L2ToL1MessageReaderNitro extends L2ToL1MessageNitro {
   public async getFirstExecutableBlock(
     l2Provider: Provider
   ): Promise<BigNumber | null> {
+    return (
+      await L2ToL1MessageReaderNitro.getFirstExecutableBlocks(
+        this.l1Provider,
+        l2Provider,
+        [this]
+      )
+    )[0]
+  }
+
+  /**
+   * Estimates the L1 block numbers in which many L2 to L1 txs will be available for execution.
+   * The recent nodes are only fetched once, and node lookups are shared between the messages.
+   * @param l1Provider
+   * @param l2Provider
+   * @param messages
+   * @returns expected L1 block numbers, in the same order as the messages. Null for messages that can be or already have been executed
+   */
+  public static async getFirstExecutableBlocks(
+    l1Provider: Provider,
+    l2Provider: Provider,
+    messages: L2ToL1MessageReaderNitro[]
+  ): Promise<(BigNumber | null)[]> {
     const l2Network = await getL2Network(l2Provider)
 
-    const rollup = RollupUserLogic__factory.connect(
+    const rollup = connectContract(
+      RollupUserLogic__factory,
       l2Network.ethBridge.rollup,
-      this.l1Provider
+      l1Provider
     )
 
-    const status = await this.status(l2Provider)
-    if (status === L2ToL1MessageStatus.EXECUTED) return null
-    if (status === L2ToL1MessageStatus.CONFIRMED) return null
-
-    // consistency check in case we change the enum in the future
-    if (status !== L2ToL1MessageStatus.UNCONFIRMED)
-      throw new ArbSdkError('L2ToL1Msg expected to be unconfirmed')
+    // only whether each message is confirmed matters here, executed or not a confirmed
+    // message has no executable block to wait for, so a single lookup of the latest
+    // confirmed node is enough
+    await L2ToL1MessageReaderNitro.setConfirmedSendProps(l2Provider, messages)
+    if (messages.every(m => m.sendRootConfirmed)) {
+      return messages.map(() => null)
+    }
 
-    const latestBlock = await this.l1Provider.getBlockNumber()
-    const eventFetcher = new EventFetcher(this.l1Provider)
-    const logs = (
-      await eventFetcher.getEvents(
+    const latestBlock = await HeadTracker.forProvider(
+      l1Provider
+    ).getBlockNumber()
+    const eventFetcher = new EventFetcher(l1Provider)
+    const filter = {
+      fromBlock: Math.max(
+        latestBlock -
+          BigNumber.from(l2Network.confirmPeriodBlocks)
+            .add(ASSERTION_CONFIRMED_PADDING)
+            .toNumber(),
+        0
+      ),
+      toBlock: latestBlock,
+      address: rollup.address,
+    }
+    const [latestConfirmed, unsortedLogs, confirmedLogs] = await Promise.all([
+      rollup.callStatic.latestConfirmed({ blockTag: latestBlock }),
+      eventFetcher.getEvents(
         RollupUserLogic__factory,
         t => t.filters.NodeCreated(),
-        {
-          fromBlock: Math.max(
-            latestBlock -
-              BigNumber.from(l2Network.confirmPeriodBlocks)
-                .add(ASSERTION_CONFIRMED_PADDING)
-                .toNumber(),
-            0
-          ),
-          toBlock: 'latest',
-          address: rollup.address,
-        }
-      )
-    ).sort((a, b) => a.event.nodeNum.toNumber() - b.event.nodeNum.toNumber())
-
-    const lastL2Block =
-      logs.length === 0
-        ? undefined
-        : await this.getBlockFromNodeLog(
-            l2Provider as JsonRpcProvider,
-            logs[logs.length - 1]
+        filter
+      ),
+      eventFetcher.getEvents(
+        RollupUserLogic__factory,
+        t => t.filters.NodeConfirmed(),
+        filter
+      ),
+    ])
+    const logs = unsortedLogs.sort(
+      (a, b) => a.event.nodeNum.toNumber() - b.event.nodeNum.toNumber()
+    )
+    // a node is confirmed after it is created, so any node created in the range
+    // that was confirmed has a NodeConfirmed event in it too. Other nodes before
+    // the latest confirmed one were rejected
+    const confirmedNums = new Set(
+      confirmedLogs.map(l => l.event.nodeNum.toNumber())
+    )
+    confirmedNums.add(latestConfirmed.toNumber())
+    const getNodeStatus = (nodeNum: BigNumber) =>
+      confirmedNums.has(nodeNum.toNumber())
+        ? RollupNodeStatus.CONFIRMED
+        : nodeNum.lt(latestConfirmed)
+        ? RollupNodeStatus.REJECTED
+        : RollupNodeStatus.UNRESOLVED
+
+    // send counts and deadlines are shared between all the messages
+    const sendCounts = new Map<number, Promise<BigNumber>>()
+    const getSendCount = (index: number) => {
+      let sendCount = sendCounts.get(index)
+      if (!sendCount) {
+        const log = logs[index]
+        sendCount = RollupNodeCache.shared
+          .getNodeFromLog(
+            rollup.address,
+            log,
+            l2Provider,
+            getNodeStatus(log.event.nodeNum)
           )
-    const lastSendCount = lastL2Block
-      ? BigNumber.from(lastL2Block.sendCount)
-      : BigNumber.from(0)
-
-    // here we assume the L2 to L1 tx is actually valid, so the user needs to wait the max time
-    // since there isn't a pending node that includes this message yet
-    if (lastSendCount.lte(this.event.position))
-      return BigNumber.from(l2Network.confirmPeriodBlocks)
-        .add(ASSERTION_CREATED_PADDING)
-        .add(ASSERTION_CONFIRMED_PADDING)
-        .add(latestBlock)
-
-    // use binary search to find the first node with sendCount > this.event.position
-    // default to the last node since we already checked above
-    let foundLog: FetchedEvent<NodeCreatedEvent> = logs[logs.length - 1]
-    let left = 0
-    let right = logs.length - 1
-    while (left <= right) {
-      const mid = Math.floor((left + right) / 2)
-      const log = logs[mid]
-      const l2Block = await this.getBlockFromNodeLog(
-        l2Provider as JsonRpcProvider,
-        log
-      )
-      const sendCount = BigNumber.from(l2Block.sendCount)
-      if (sendCount.gt(this.event.position)) {
-        foundLog = log
-        right = mid - 1
-      } else {
-        left = mid + 1
+          .then(n => n.sendCount)
+        sendCounts.set(index, sendCount)
+      }
+      return sendCount
+    }
+    const deadlines = new Map<number, Promise<BigNumber>>()
+    const getDeadline = (index: number) => {
+      let deadline = deadlines.get(index)
+      if (!deadline) {
+        deadline = rollup
+          .getNode(logs[index].event.nodeNum)
+          .then(n => n.deadlineBlock.add(ASSERTION_CONFIRMED_PADDING))
+        deadlines.set(index, deadline)
       }
+      return deadline
     }
 
-    const earliestNodeWithExit = foundLog.event.nodeNum
-    const node = await rollup.getNode(earliestNodeWithExit)
-    return node.deadlineBlock.add(ASSERTION_CONFIRMED_PADDING)
+    return await mapConcurrently(
+      messages,
+      MESSAGE_CONCURRENCY,
+      async message => {
+        if (message.sendRootConfirmed) return null
+
+        // find the first node with sendCount > this.event.position
+        const index = await searchFirstNodeAfter(
+          logs.length,
+          message.event.position,
+          getSendCount
+        )
+
+        // here we assume the L2 to L1 tx is actually valid, so the user needs to wait the max time
+        // since there isn't a pending node that includes this message yet
+        if (index === undefined)
+          return BigNumber.from(l2Network.confirmPeriodBlocks)
+            .add(ASSERTION_CREATED_PADDING)
+            .add(ASSERTION_CONFIRMED_PADDING)
+            .add(latestBlock)
+
+        return await getDeadline(index)
+      }
+    )
   }
 }
 
@@ -426,7 +706,8 @@ export class L2ToL1MessageWriterNitro extends L2ToL1MessageReaderNitro {
     }
     const proof = await this.getOutboxProof(l2Provider)
     const l2Network = await getL2Network(l2Provider)
-    const outbox = Outbox__factory.connect(
+    const outbox = connectContract(
+      Outbox__factory,
       l2Network.ethBridge.outbox,
       this.l1Signer
     )
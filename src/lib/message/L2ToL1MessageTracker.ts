@@ -0,0 +1,361 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { Provider } from '@ethersproject/abstract-provider'
+import { BigNumber } from '@ethersproject/bignumber'
+
+import { RollupUserLogic__factory } from '../abi/factories/RollupUserLogic__factory'
+import { Outbox__factory } from '../abi/factories/Outbox__factory'
+import { RollupUserLogic } from '../abi/RollupUserLogic'
+import { EventFetcher, EventFetcherOptions } from '../utils/eventFetcher'
+import { CallInput, MultiCaller } from '../utils/multicall'
+import { isDefined, mapConcurrently } from '../utils/lib'
+import { HeadTracker } from '../utils/headTracker'
+import { getL2Network, L2Network } from '../dataEntities/networks'
+import { L2ToL1MessageStatus } from '../dataEntities/message'
+import {
+  RollupNodeCache,
+  RollupNodeInfo,
+  RollupNodeStatus,
+} from './RollupNodeCache'
+import { connectContract, getInterface } from '../utils/contractCache'
+
+/**
+ * A rollup node, along with whether it has been confirmed
+ */
+export type TrackedNode = RollupNodeInfo & {
+  confirmed: boolean
+}
+
+export type L2ToL1MessageTrackerOptions = {
+  /**
+   * Options for the NodeCreated and NodeConfirmed log queries
+   */
+  eventFetcherOptions?: EventFetcherOptions
+  /**
+   * Max number of L2 blocks fetched at once when resolving new nodes. Defaults to 10
+   */
+  concurrency?: number
+  /**
+   * Cache for confirmed nodes. Defaults to the process wide RollupNodeCache.shared
+   */
+  nodeCache?: RollupNodeCache
+  /**
+   * Only blocks at least this far behind the latest L1 block are synced, so that
+   * reorged node events are never tracked or cached. Defaults to 64
+   */
+  finalityDepth?: number
+}
+
+const DEFAULT_CONCURRENCY = 10
+const DEFAULT_FINALITY_DEPTH = 64
+
+/**
+ * Keeps an incrementally updated view of the rollup nodes from the latest confirmed node
+ * onwards, so that the status of any number of nitro L2->L1 messages can be found
+ * without querying the rollup for each one.
+ *
+ * Each call to sync only fetches the NodeCreated and NodeConfirmed events emitted since
+ * the previous sync, and the L2 blocks of the newly created nodes. Statuses reflect
+ * the last sync, the first status query syncs automatically. Syncs stop
+ * options.finalityDepth blocks behind the L1 head, so recently created or confirmed
+ * nodes are only seen once that many blocks have passed.
+ */
+export class L2ToL1MessageTracker {
+  /**
+   * Nodes from the latest confirmed node onwards, sorted by node number
+   */
+  private nodes: TrackedNode[] = []
+  private latestConfirmed?: TrackedNode
+  private latestConfirmedNum = 0
+  private syncedToBlock?: number
+  private syncing?: Promise<void>
+  /**
+   * Positions of messages known to be executed, which can never be unexecuted
+   */
+  private readonly executed = new Set<string>()
+
+  private readonly rollup: RollupUserLogic
+  private readonly eventFetcher: EventFetcher
+  private readonly nodeCache: RollupNodeCache
+
+  /**
+   * @param l1Provider
+   * @param l2Provider
+   * @param l2Network
+   * @param multiCaller A multicaller on the L1 network, used to check whether messages have been executed
+   * @param options
+   */
+  public constructor(
+    public readonly l1Provider: Provider,
+    public readonly l2Provider: Provider,
+    public readonly l2Network: L2Network,
+    private readonly multiCaller: MultiCaller,
+    private readonly options?: L2ToL1MessageTrackerOptions
+  ) {
+    this.rollup = connectContract(
+      RollupUserLogic__factory,
+      l2Network.ethBridge.rollup,
+      l1Provider
+    )
+    this.eventFetcher = new EventFetcher(
+      l1Provider,
+      options?.eventFetcherOptions
+    )
+    this.nodeCache = options?.nodeCache || RollupNodeCache.shared
+  }
+
+  /**
+   * Create a tracker for the L2 network of the l2Provider
+   * @param l1Provider
+   * @param l2Provider
+   * @param options
+   * @returns
+   */
+  public static async fromProviders(
+    l1Provider: Provider,
+    l2Provider: Provider,
+    options?: L2ToL1MessageTrackerOptions
+  ): Promise<L2ToL1MessageTracker> {
+    return new L2ToL1MessageTracker(
+      l1Provider,
+      l2Provider,
+      await getL2Network(l2Provider),
+      await MultiCaller.fromProvider(l1Provider),
+      options
+    )
+  }
+
+  /**
+   * Fetch any nodes created or confirmed since the last sync
+   */
+  public async sync(): Promise<void> {
+    // concurrent callers share a single sync
+    if (!this.syncing) {
+      this.syncing = this.syncNodes().finally(() => {
+        this.syncing = undefined
+      })
+    }
+    return await this.syncing
+  }
+
+  private async syncNodes(): Promise<void> {
+    // syncedToBlock only moves forward, so blocks that could still be reorged are
+    // left for a later sync
+    const finalityDepth = isDefined(this.options?.finalityDepth)
+      ? this.options!.finalityDepth
+      : DEFAULT_FINALITY_DEPTH
+    const head = await HeadTracker.forProvider(this.l1Provider).getBlockNumber()
+    const toBlock = Math.max(head - finalityDepth, 0)
+    let fromBlock: number
+    if (this.syncedToBlock === undefined) {
+      // start from the latest confirmed node, every message before it is confirmed
+      const latestConfirmedNum = await this.rollup.callStatic.latestConfirmed({
+        blockTag: toBlock,
+      })
+      const node = await this.rollup.getNode(latestConfirmedNum, {
+        blockTag: toBlock,
+      })
+      fromBlock = node.createdAtBlock.toNumber()
+      this.latestConfirmedNum = latestConfirmedNum.toNumber()
+    } else fromBlock = this.syncedToBlock + 1
+    if (fromBlock > toBlock) return
+
+    const filter = { fromBlock, toBlock, address: this.rollup.address }
+    const [createdEvents, confirmedEvents] = await Promise.all([
+      this.eventFetcher.getEvents(
+        RollupUserLogic__factory,
+        t => t.filters.NodeCreated(),
+        filter
+      ),
+      this.eventFetcher.getEvents(
+        RollupUserLogic__factory,
+        t => t.filters.NodeConfirmed(),
+        filter
+      ),
+    ])
+
+    // every node after the previous latest confirmed node that was confirmed since
+    // has a NodeConfirmed event in this range, any other node before the new
+    // latest confirmed node was rejected
+    const confirmedNums = new Set([this.latestConfirmedNum])
+    for (const e of confirmedEvents) {
+      const nodeNum = e.event.nodeNum.toNumber()
+      confirmedNums.add(nodeNum)
+      this.latestConfirmedNum = Math.max(this.latestConfirmedNum, nodeNum)
+    }
+    const getStatus = (nodeNum: number) =>
+      confirmedNums.has(nodeNum)
+        ? RollupNodeStatus.CONFIRMED
+        : nodeNum < this.latestConfirmedNum
+        ? RollupNodeStatus.REJECTED
+        : RollupNodeStatus.UNRESOLVED
+
+    const created = await mapConcurrently(
+      createdEvents,
+      this.options?.concurrency || DEFAULT_CONCURRENCY,
+      async e => ({
+        ...(await this.nodeCache.getNodeFromLog(
+          this.rollup.address,
+          e,
+          this.l2Provider,
+          getStatus(e.event.nodeNum.toNumber())
+        )),
+        confirmed: false,
+      })
+    )
+
+    // nodes tracked by earlier syncs may have been resolved since
+    for (const node of this.nodes) {
+      const { confirmed: _, ...nodeInfo } = node
+      this.nodeCache.set(
+        this.rollup.address,
+        nodeInfo,
+        getStatus(node.nodeNum)
+      )
+    }
+
+    // nodes are confirmed in order, so only nodes from the latest confirmed
+    // node onwards are needed for status lookups
+    const nodes = this.nodes
+      .concat(created)
+      .filter(n => n.nodeNum >= this.latestConfirmedNum)
+      .sort((a, b) => a.nodeNum - b.nodeNum)
+    for (const node of nodes) {
+      if (node.nodeNum === this.latestConfirmedNum) {
+        node.confirmed = true
+        this.latestConfirmed = node
+      }
+    }
+    this.nodes = nodes
+    this.syncedToBlock = toBlock
+  }
+
+  /**
+   * The latest confirmed node as of the last sync
+   */
+  public getLatestConfirmedNode(): TrackedNode | undefined {
+    return this.latestConfirmed
+  }
+
+  /**
+   * Find the earliest known node that includes the message at this position
+   * @param position
+   * @returns Undefined if no node including the message has been created yet
+   */
+  public getNodeForPosition(position: BigNumber): TrackedNode | undefined {
+    // binary search for the first node with sendCount > position
+    let left = 0
+    let right = this.nodes.length - 1
+    let found: TrackedNode | undefined
+    while (left <= right) {
+      const mid = Math.floor((left + right) / 2)
+      if (this.nodes[mid].sendCount.gt(position)) {
+        found = this.nodes[mid]
+        right = mid - 1
+      } else left = mid + 1
+    }
+    return found
+  }
+
+  /**
+   * Get the send props of the latest node that can be used to prove the message at
+   * this position. The same values as L2ToL1MessageReaderNitro provides.
+   * @param position
+   */
+  public async getSendProps(position: BigNumber): Promise<{
+    sendRootSize?: BigNumber
+    sendRootHash?: string
+    sendRootConfirmed?: boolean
+  }> {
+    if (this.syncedToBlock === undefined) await this.sync()
+
+    const confirmed = this.latestConfirmed
+    if (confirmed && confirmed.sendCount.gt(position)) {
+      return {
+        sendRootSize: confirmed.sendCount,
+        sendRootHash: confirmed.sendRoot,
+        sendRootConfirmed: true,
+      }
+    }
+    const latest = this.nodes[this.nodes.length - 1]
+    if (latest && latest.sendCount.gt(position)) {
+      return {
+        sendRootSize: latest.sendCount,
+        sendRootHash: latest.sendRoot,
+        sendRootConfirmed: false,
+      }
+    }
+    return {}
+  }
+
+  /**
+   * Get the status of a single message, see getStatuses
+   * @param event
+   * @returns
+   */
+  public async getStatus(event: {
+    position: BigNumber
+  }): Promise<L2ToL1MessageStatus> {
+    return (await this.getStatuses([event]))[0]
+  }
+
+  /**
+   * Get the statuses of many messages. Confirmation is a local lookup, executed
+   * checks for confirmed messages are batched into multicalls.
+   * @param events The L2ToL1Tx events of the messages
+   * @returns Statuses in the same order as the events
+   */
+  public async getStatuses(
+    events: { position: BigNumber }[]
+  ): Promise<L2ToL1MessageStatus[]> {
+    if (this.syncedToBlock === undefined) await this.sync()
+
+    const confirmedSendCount = this.latestConfirmed
+      ? this.latestConfirmed.sendCount
+      : BigNumber.from(0)
+    const unknown = events
+      .map(e => e.position)
+      .filter(
+        p => confirmedSendCount.gt(p) && !this.executed.has(p.toHexString())
+      )
+
+    if (unknown.length > 0) {
+      const outboxIface = getInterface(Outbox__factory)
+      const calls: CallInput<boolean>[] = unknown.map(position => ({
+        targetAddr: this.l2Network.ethBridge.outbox,
+        encoder: () => outboxIface.encodeFunctionData('isSpent', [position]),
+        decoder: (returnData: string) =>
+          outboxIface.decodeFunctionResult('isSpent', returnData)[0],
+      }))
+      const spent = await this.multiCaller.multiCall(calls, true)
+      unknown.forEach((p, i) => {
+        if (spent[i]) this.executed.add(p.toHexString())
+      })
+    }
+
+    return events.map(e => {
+      if (!confirmedSendCount.gt(e.position)) {
+        return L2ToL1MessageStatus.UNCONFIRMED
+      }
+      return this.executed.has(e.position.toHexString())
+        ? L2ToL1MessageStatus.EXECUTED
+        : L2ToL1MessageStatus.CONFIRMED
+    })
+  }
+}
@@ -39,6 +39,7 @@ import { ArbSdkError } from '../dataEntities/errors'
 import { NODE_INTERFACE_ADDRESS } from '../dataEntities/constants'
 import { EventArgs, parseTypedLogs } from '../dataEntities/event'
 import { ArbitrumProvider } from '../utils/arbProvider'
+import { connectContract } from '../utils/contractCache'
 
 export interface L2ContractTransaction extends ContractTransaction {
   wait(confirmations?: number): Promise<L2TransactionReceipt>
@@ -136,7 +137,8 @@ export class L2TransactionReceipt implements TransactionReceipt {
    * @returns number of confirmations of batch including tx, or 0 if no batch included this tx
    */
   public getBatchConfirmations(l2Provider: providers.JsonRpcProvider) {
-    const nodeInterface = NodeInterface__factory.connect(
+    const nodeInterface = connectContract(
+      NodeInterface__factory,
       NODE_INTERFACE_ADDRESS,
       l2Provider
     )
@@ -149,11 +151,12 @@ export class L2TransactionReceipt implements TransactionReceipt {
    * @returns number of batch in which tx was included, or errors if no batch includes the current tx
    */
   public async getBatchNumber(l2Provider: providers.JsonRpcProvider) {
-    const nodeInterface = NodeInterface__factory.connect(
+    const nodeInterface = connectContract(
+      NodeInterface__factory,
       NODE_INTERFACE_ADDRESS,
       l2Provider
     )
-    const arbProvider = new ArbitrumProvider(l2Provider)
+    const arbProvider = ArbitrumProvider.fromProvider(l2Provider)
     const rec = await arbProvider.getTransactionReceipt(this.transactionHash)
     if (rec == null)
       throw new ArbSdkError(
@@ -0,0 +1,328 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { Provider } from '@ethersproject/abstract-provider'
+import { TransactionReceipt } from '@ethersproject/providers'
+
+import { ArbRetryableTx__factory } from '../abi/factories/ArbRetryableTx__factory'
+import { decodeRedeemScheduledEvent } from '../abi/fastCodecs'
+import {
+  CanceledEvent,
+  LifetimeExtendedEvent,
+  RedeemScheduledEvent,
+  TicketCreatedEvent,
+} from '../abi/ArbRetryableTx'
+import { TypedEventFilter } from '../abi/common'
+import { ARB_RETRYABLE_TX_ADDRESS } from '../dataEntities/constants'
+import { EventArgs } from '../dataEntities/event'
+import { getL2Network } from '../dataEntities/networks'
+import { EventFetcher, EventFetcherOptions } from '../utils/eventFetcher'
+import { HeadTracker } from '../utils/headTracker'
+import { getTransactionReceipts } from '../utils/jsonRpcBatcher'
+import { mapConcurrently } from '../utils/lib'
+import { LruCache } from '../utils/lruCache'
+
+/**
+ * The state of a retryable ticket as of the last sync of a RetryableRedeemScanner
+ */
+export type IndexedTicket = {
+  /**
+   * L2 block the ticket was created in
+   */
+  createdBlock: number
+  /**
+   * Timestamp after which the ticket can no longer be redeemed, including any extensions
+   */
+  timeout: number
+  /**
+   * Receipt of the successful redeem, once the ticket has been redeemed
+   */
+  redeemReceipt?: TransactionReceipt
+  /**
+   * Whether the ticket no longer exists, because it was redeemed, cancelled or expired
+   */
+  closed: boolean
+}
+
+export type RetryableRedeemScannerOptions = {
+  /**
+   * Options for the log queries. Syncs are split into pages of pageSize blocks, 10000 by
+   * default, and the scanner's progress is kept after each page
+   */
+  eventFetcherOptions?: EventFetcherOptions
+  /**
+   * Max number of closed tickets to keep in the index, the least recently used are
+   * dropped first. Defaults to 10000
+   */
+  maxClosedTickets?: number
+}
+
+const DEFAULT_MAX_CLOSED_TICKETS = 10000
+const BLOCK_FETCH_CONCURRENCY = 8
+
+type TicketEntry = IndexedTicket & {
+  /**
+   * Scheduled redeems whose receipts were not yet available
+   */
+  pendingRedeems: string[]
+}
+
+/**
+ * Keeps an index of the retryable tickets created since a block, built from the TicketCreated,
+ * RedeemScheduled, LifetimeExtended and Canceled logs of ArbRetryableTx.
+ *
+ * Each call to sync only fetches the logs emitted since the previous sync, with a single query
+ * covering all four events, so one scanner can serve any number of L1ToL2MessageReaders instead
+ * of each of them looking up its ticket. During a sync the receipts of the scheduled redeems and
+ * the creation blocks of new tickets are fetched, so that the status of an indexed ticket is
+ * known without further requests.
+ *
+ * Tickets that are still open are kept until they close, closed tickets are kept in a bounded
+ * cache. Tickets that are not in the index are looked up by the readers as usual.
+ */
+export class RetryableRedeemScanner {
+  private readonly openTickets = new Map<string, TicketEntry>()
+  /**
+   * Open tickets with redeems whose receipts have not been looked up yet
+   */
+  private readonly pendingRedeems = new Map<string, TicketEntry>()
+  private readonly closedTickets: LruCache<string, TicketEntry>
+  private readonly eventFetcher: EventFetcher
+  private lifetimeSeconds?: Promise<number>
+  private syncedTo?: number
+  private syncing?: Promise<number>
+
+  /**
+   * @param l2Provider
+   * @param fromBlock First L2 block to index. Only tickets created at or after this block are indexed
+   * @param options
+   */
+  public constructor(
+    public readonly l2Provider: Provider,
+    public readonly fromBlock: number,
+    options?: RetryableRedeemScannerOptions
+  ) {
+    this.eventFetcher = new EventFetcher(
+      l2Provider,
+      options?.eventFetcherOptions
+    )
+    this.closedTickets = new LruCache(
+      options?.maxClosedTickets ?? DEFAULT_MAX_CLOSED_TICKETS
+    )
+  }
+
+  /**
+   * The last L2 block that has been indexed, undefined if the scanner has never synced
+   */
+  public get syncedToBlock(): number | undefined {
+    return this.syncedTo
+  }
+
+  /**
+   * Index the logs emitted since the last sync
+   * @returns The last L2 block that has been indexed
+   */
+  public async sync(): Promise<number> {
+    // concurrent callers share a single sync
+    if (!this.syncing) {
+      this.syncing = this.syncLogs().finally(() => {
+        this.syncing = undefined
+      })
+    }
+    return await this.syncing
+  }
+
+  private async syncLogs(): Promise<number> {
+    const head = await HeadTracker.forProvider(this.l2Provider).getHead()
+    const fromBlock = Math.max(
+      this.fromBlock,
+      this.syncedTo === undefined ? 0 : this.syncedTo + 1
+    )
+    if (fromBlock <= head.number) await this.indexLogs(fromBlock, head.number)
+    // redeems whose receipts were missing are looked up again even without new blocks
+    else await this.checkPendingRedeems()
+    // the provider may be behind the last sync
+    if (this.syncedTo === undefined || head.number > this.syncedTo) {
+      this.syncedTo = head.number
+    }
+
+    // nothing can be redeemed after the synced block, so tickets whose timeout has
+    // passed by then have expired. Those with redeems still pending are checked again
+    // on the next sync
+    for (const [ticketId, entry] of Array.from(this.openTickets.entries())) {
+      if (entry.timeout < head.timestamp && entry.pendingRedeems.length === 0) {
+        entry.closed = true
+        this.closeTicket(ticketId, entry)
+      }
+    }
+    return this.syncedTo
+  }
+
+  /**
+   * Index the logs in a range a page at a time, so a failed sync resumes after the last page
+   */
+  private async indexLogs(fromBlock: number, toBlock: number) {
+    for await (const page of this.eventFetcher.streamEvents(
+      ArbRetryableTx__factory,
+      t =>
+        ({
+          topics: [
+            [
+              t.interface.getEventTopic('TicketCreated'),
+              t.interface.getEventTopic('RedeemScheduled'),
+              t.interface.getEventTopic('LifetimeExtended'),
+              t.interface.getEventTopic('Canceled'),
+            ],
+          ],
+        } as TypedEventFilter<
+          | TicketCreatedEvent
+          | RedeemScheduledEvent
+          | LifetimeExtendedEvent
+          | CanceledEvent
+        >),
+      { fromBlock, toBlock, address: ARB_RETRYABLE_TX_ADDRESS }
+    )) {
+      const created = page.events.filter(e => e.name === 'TicketCreated')
+      const creationTimestamps = await this.getTimestamps(
+        Array.from(new Set(created.map(e => e.blockNumber)))
+      )
+      const lifetimeSeconds = created.length > 0 ? await this.getLifetime() : 0
+
+      for (const e of page.events) {
+        // the ticket id is the first indexed arg of all four events
+        const ticketId = e.topics[1].toLowerCase()
+        if (e.name === 'TicketCreated') {
+          this.openTickets.set(ticketId, {
+            createdBlock: e.blockNumber,
+            timeout: creationTimestamps.get(e.blockNumber)! + lifetimeSeconds,
+            closed: false,
+            pendingRedeems: [],
+          })
+          continue
+        }
+        // events of tickets that are not indexed, as they were created before
+        // the first block, are ignored
+        const entry = this.openTickets.get(ticketId)
+        if (!entry) continue
+        if (e.name === 'RedeemScheduled') {
+          entry.pendingRedeems.push(decodeRedeemScheduledEvent(e).retryTxHash)
+          this.pendingRedeems.set(ticketId, entry)
+        } else if (e.name === 'LifetimeExtended') {
+          const args = e.event as EventArgs<LifetimeExtendedEvent>
+          entry.timeout = Math.max(entry.timeout, args.newTimeout.toNumber())
+        } else {
+          entry.closed = true
+          this.closeTicket(ticketId, entry)
+        }
+      }
+
+      await this.checkPendingRedeems()
+      this.syncedTo = page.cursor.blockNumber
+    }
+  }
+
+  /**
+   * Look up the receipts of the scheduled redeems. The retry transaction is executed in
+   * the same block as it is scheduled, so a missing receipt is only due to a lagging node
+   * and is looked up again on the next sync.
+   */
+  private async checkPendingRedeems() {
+    const pending: { ticketId: string; entry: TicketEntry; txHash: string }[] =
+      []
+    for (const [ticketId, entry] of Array.from(this.pendingRedeems.entries())) {
+      for (const txHash of entry.pendingRedeems) {
+        pending.push({ ticketId, entry, txHash })
+      }
+    }
+    if (pending.length === 0) return
+    const receipts = await getTransactionReceipts(
+      this.l2Provider,
+      pending.map(p => p.txHash)
+    )
+
+    pending.forEach(({ ticketId, entry, txHash }, i) => {
+      const receipt = receipts[i]
+      if (!receipt) return
+      entry.pendingRedeems = entry.pendingRedeems.filter(h => h !== txHash)
+      if (entry.pendingRedeems.length === 0) {
+        this.pendingRedeems.delete(ticketId)
+      }
+      if (receipt.status === 1 && !entry.redeemReceipt) {
+        entry.redeemReceipt = receipt
+        entry.closed = true
+      }
+      if (entry.closed && entry.pendingRedeems.length === 0) {
+        this.closeTicket(ticketId, entry)
+      }
+    })
+  }
+
+  /**
+   * Move a redeemed, cancelled or expired ticket out of the open tickets
+   */
+  private closeTicket(ticketId: string, entry: TicketEntry) {
+    // wait for the pending redeems, as one of them may be the successful redeem
+    if (entry.pendingRedeems.length > 0) return
+    this.openTickets.delete(ticketId)
+    this.closedTickets.set(ticketId, entry)
+  }
+
+  private async getTimestamps(
+    blockNumbers: number[]
+  ): Promise<Map<number, number>> {
+    const timestamps = await mapConcurrently(
+      blockNumbers,
+      BLOCK_FETCH_CONCURRENCY,
+      async n => (await this.l2Provider.getBlock(n)).timestamp
+    )
+    return new Map(blockNumbers.map((n, i) => [n, timestamps[i]]))
+  }
+
+  private getLifetime(): Promise<number> {
+    if (!this.lifetimeSeconds) {
+      this.lifetimeSeconds = getL2Network(this.l2Provider).then(
+        n => n.retryableLifetimeSeconds
+      )
+      // retry on the next call if the network could not be found
+      this.lifetimeSeconds.catch(() => {
+        this.lifetimeSeconds = undefined
+      })
+    }
+    return this.lifetimeSeconds
+  }
+
+  /**
+   * The state of a ticket as of the last sync
+   * @param ticketId
+   * @returns Undefined if the ticket is not in the index, because it was created before the
+   * first indexed block, after the last sync, or it was closed and has since been dropped.
+   * Also undefined while the receipt of a scheduled redeem could not be found
+   */
+  public getTicket(ticketId: string): IndexedTicket | undefined {
+    const key = ticketId.toLowerCase()
+    const entry = this.openTickets.get(key) || this.closedTickets.get(key)
+    // the outcome of a pending redeem is not known yet
+    if (!entry || entry.pendingRedeems.length > 0) return undefined
+    return {
+      createdBlock: entry.createdBlock,
+      timeout: entry.timeout,
+      redeemReceipt: entry.redeemReceipt,
+      closed: entry.closed,
+    }
+  }
+}
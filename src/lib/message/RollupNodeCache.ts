@@ -0,0 +1,246 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { Provider } from '@ethersproject/abstract-provider'
+import { BigNumber, BigNumberish } from '@ethersproject/bignumber'
+import { JsonRpcProvider } from '@ethersproject/providers'
+
+import { RollupUserLogic__factory } from '../abi/factories/RollupUserLogic__factory'
+import { NodeCreatedEvent, RollupUserLogic } from '../abi/RollupUserLogic'
+import { ArbitrumProvider } from '../utils/arbProvider'
+import { EventFetcher, FetchedEvent } from '../utils/eventFetcher'
+import { LruCache } from '../utils/lruCache'
+import { ArbSdkError } from '../dataEntities/errors'
+
+/**
+ * A rollup node's assertion, along with the send count and send root of the L2 block it asserts
+ */
+export type RollupNodeInfo = {
+  nodeNum: number
+  /**
+   * L1 block the node was created in
+   */
+  createdAtBlock: number
+  /**
+   * Hash of the L2 block asserted by the node
+   */
+  blockHash: string
+  /**
+   * Send root of the L2 block asserted by the node
+   */
+  sendRoot: string
+  /**
+   * Number of L2->L1 messages sent up to and including the asserted L2 block
+   */
+  sendCount: BigNumber
+  /**
+   * Number of the L2 block asserted by the node
+   */
+  l2BlockNumber: number
+}
+
+export enum RollupNodeStatus {
+  /**
+   * The node has been neither confirmed nor rejected yet
+   */
+  UNRESOLVED,
+  CONFIRMED,
+  /**
+   * The node was rejected, eg. a sibling of a confirmed node
+   */
+  REJECTED,
+}
+
+/**
+ * A resolved node held in the cache, along with whether it was confirmed or rejected
+ */
+export type CachedRollupNode = RollupNodeInfo & {
+  status: RollupNodeStatus.CONFIRMED | RollupNodeStatus.REJECTED
+}
+
+const DEFAULT_MAX_SIZE = 10000
+
+/**
+ * A bounded cache of rollup nodes keyed by (rollup address, node number).
+ * Only resolved nodes are stored, along with whether they were confirmed or rejected,
+ * since they can no longer be affected by L1 reorgs, so a cached node never needs to be
+ * refetched. Lookups for the same node that are in flight at the same time share a single fetch.
+ */
+export class RollupNodeCache {
+  /**
+   * Process wide cache shared by all L2->L1 messages
+   */
+  public static readonly shared = new RollupNodeCache()
+
+  private readonly nodes: LruCache<string, CachedRollupNode>
+  private readonly inFlight = new Map<string, Promise<RollupNodeInfo>>()
+
+  /**
+   * @param maxSize Max number of nodes held. Defaults to 10000
+   */
+  public constructor(maxSize = DEFAULT_MAX_SIZE) {
+    this.nodes = new LruCache(maxSize)
+  }
+
+  private static getKey(rollupAddress: string, nodeNum: BigNumberish) {
+    const num = BigNumber.from(nodeNum).toString()
+    return `${rollupAddress.toLowerCase()}:${num}`
+  }
+
+  public get(
+    rollupAddress: string,
+    nodeNum: BigNumberish
+  ): CachedRollupNode | undefined {
+    return this.nodes.get(RollupNodeCache.getKey(rollupAddress, nodeNum))
+  }
+
+  /**
+   * Store a node, unresolved nodes are ignored
+   * @param rollupAddress
+   * @param node
+   * @param status
+   */
+  public set(
+    rollupAddress: string,
+    node: RollupNodeInfo,
+    status: RollupNodeStatus
+  ): void {
+    if (status === RollupNodeStatus.UNRESOLVED) return
+    this.nodes.set(RollupNodeCache.getKey(rollupAddress, node.nodeNum), {
+      ...node,
+      status,
+    })
+  }
+
+  /**
+   * Get a node by number, fetching its NodeCreated event and asserted L2 block if not cached
+   * @param rollup
+   * @param nodeNum
+   * @param l2Provider
+   * @param status The status of the node, only confirmed and rejected nodes are cached
+   * @returns
+   */
+  public async getNode(
+    rollup: RollupUserLogic,
+    nodeNum: BigNumberish,
+    l2Provider: Provider,
+    status: RollupNodeStatus
+  ): Promise<RollupNodeInfo> {
+    const fetchNode = async () => {
+      const node = await rollup.getNode(nodeNum)
+
+      // now get the block hash and sendroot for that node
+      const eventFetcher = new EventFetcher(rollup.provider)
+      const logs = await eventFetcher.getEvents(
+        RollupUserLogic__factory,
+        t => t.filters.NodeCreated(nodeNum),
+        {
+          fromBlock: node.createdAtBlock.toNumber(),
+          toBlock: node.createdAtBlock.toNumber(),
+          address: rollup.address,
+        }
+      )
+
+      if (logs.length !== 1) {
+        throw new ArbSdkError('No NodeCreated events found')
+      }
+      return await RollupNodeCache.resolveNodeLog(logs[0], l2Provider)
+    }
+
+    return await this.getOrFetch(rollup.address, nodeNum, status, fetchNode)
+  }
+
+  /**
+   * Get a node from its NodeCreated event, fetching the asserted L2 block if not cached
+   * @param rollupAddress
+   * @param log
+   * @param l2Provider
+   * @param status The status of the node, only confirmed and rejected nodes are cached
+   * @returns
+   */
+  public async getNodeFromLog(
+    rollupAddress: string,
+    log: FetchedEvent<NodeCreatedEvent>,
+    l2Provider: Provider,
+    status: RollupNodeStatus
+  ): Promise<RollupNodeInfo> {
+    return await this.getOrFetch(
+      rollupAddress,
+      log.event.nodeNum,
+      status,
+      () => RollupNodeCache.resolveNodeLog(log, l2Provider)
+    )
+  }
+
+  private async getOrFetch(
+    rollupAddress: string,
+    nodeNum: BigNumberish,
+    status: RollupNodeStatus,
+    fetchNode: () => Promise<RollupNodeInfo>
+  ): Promise<RollupNodeInfo> {
+    const key = RollupNodeCache.getKey(rollupAddress, nodeNum)
+    const cached = this.nodes.get(key)
+    if (cached) {
+      const { status: _, ...node } = cached
+      return node
+    }
+
+    let fetching = this.inFlight.get(key)
+    if (!fetching) {
+      fetching = fetchNode().finally(() => this.inFlight.delete(key))
+      this.inFlight.set(key, fetching)
+    }
+    const node = await fetching
+    this.set(rollupAddress, node, status)
+    return node
+  }
+
+  /**
+   * Parse the assertion in a NodeCreated event and look up the asserted L2 block
+   */
+  private static async resolveNodeLog(
+    log: FetchedEvent<NodeCreatedEvent>,
+    l2Provider: Provider
+  ): Promise<RollupNodeInfo> {
+    const globalState = log.event.assertion.afterState.globalState
+    const blockHash = globalState.bytes32Vals[0]
+    const sendRoot = globalState.bytes32Vals[1]
+
+    const arbitrumProvider = ArbitrumProvider.fromProvider(
+      l2Provider as JsonRpcProvider
+    )
+    const l2Block = await arbitrumProvider.getBlock(blockHash)
+    if (!l2Block) {
+      throw new ArbSdkError(`Block not found. ${blockHash}`)
+    }
+    if (l2Block.sendRoot !== sendRoot) {
+      throw new ArbSdkError(
+        `L2 block send root doesn't match parsed log. ${l2Block.sendRoot} ${sendRoot}`
+      )
+    }
+
+    return {
+      nodeNum: log.event.nodeNum.toNumber(),
+      createdAtBlock: log.blockNumber,
+      blockHash,
+      sendRoot,
+      sendCount: BigNumber.from(l2Block.sendCount),
+      l2BlockNumber: l2Block.number,
+    }
+  }
+}
@@ -6,12 +6,16 @@ import {
   JsonRpcFetchFunc,
 } from '@ethersproject/providers'
 import { Formats } from '@ethersproject/providers/lib/formatter'
-import { Networkish } from '@ethersproject/networks'
+import { Network, Networkish } from '@ethersproject/networks'
 import {
   ArbBlock,
   ArbBlockWithTransactions,
   ArbTransactionReceipt,
 } from '../dataEntities/rpc'
+import { JsonRpcBatcher } from './jsonRpcBatcher'
+import { HeadTracker } from './headTracker'
+import { RpcResultCache } from './rpcResultCache'
+import { ArbSdkError } from '../dataEntities/errors'
 
 class ArbFormatter extends Formatter {
   readonly formats!: Formats
@@ -63,19 +67,124 @@ class ArbFormatter extends Formatter {
   }
 }
 
+// requests that are sent in JSON-RPC batches when made concurrently
+const BATCHED_METHODS = new Set([
+  'eth_getBlockByHash',
+  'eth_getTransactionReceipt',
+  'eth_call',
+  'eth_getLogs',
+])
+
 /**
  * Arbitrum specific formats
  */
 export class ArbitrumProvider extends Web3Provider {
   private static arbFormatter = new ArbFormatter()
+  private static readonly providers = new WeakMap<
+    JsonRpcProvider,
+    ArbitrumProvider
+  >()
+
+  private detectedNetwork?: Promise<Network>
+
+  /**
+   * Optional cache of blocks by hash and of final receipts
+   */
+  public readonly cache?: RpcResultCache
 
   /**
-   * Arbitrum specific formats
+   * Arbitrum specific formats. Concurrent block by hash, receipt, call and log requests
+   * are combined into JSON-RPC batches through the provider's shared JsonRpcBatcher,
+   * and identical requests in flight at the same time share a single request.
+   * If the provider overrides send, eg. to add auth headers or retries, it is not
+   * batched and all requests go through its send.
+   * Prefer ArbitrumProvider.fromProvider, which reuses one instance per provider
    * @param provider Must be connected to an Arbitrum network
    * @param network Must be an Arbitrum network
+   * @param cache Optional cache of blocks by hash and of final receipts
+   */
+  public constructor(
+    provider: JsonRpcProvider,
+    network?: Networkish,
+    cache?: RpcResultCache
+  ) {
+    const batcher = JsonRpcBatcher.forProvider(provider)
+    const inFlight = new Map<string, Promise<any>>()
+    const send: JsonRpcFetchFunc = (method, params = []) => {
+      if (!BATCHED_METHODS.has(method)) return provider.send(method, params)
+
+      const key = `${method}:${JSON.stringify(params)}`
+      let request = inFlight.get(key)
+      if (!request) {
+        request = batcher
+          .send(method, params)
+          .finally(() => inFlight.delete(key))
+        inFlight.set(key, request)
+      }
+      return request
+    }
+    super(send, network)
+    this.cache = cache
+  }
+
+  /**
+   * Get the ArbitrumProvider shared by all users of a provider, so that network
+   * detection and in flight requests are shared rather than repeated per instance.
+   * The cache of the shared instance is fixed when it is created, so to use one call
+   * this before the provider is used. Throws if the shared instance already exists
+   * with a different cache
+   * @param provider Must be connected to an Arbitrum network
+   * @param cache Optional cache of blocks by hash and of final receipts
+   * @returns
    */
-  public constructor(provider: JsonRpcProvider, network?: Networkish) {
-    super(provider.send.bind(provider) as JsonRpcFetchFunc, network)
+  public static fromProvider(
+    provider: JsonRpcProvider,
+    cache?: RpcResultCache
+  ): ArbitrumProvider {
+    let arbProvider: ArbitrumProvider | undefined
+    if (provider instanceof ArbitrumProvider) arbProvider = provider
+    else {
+      arbProvider = this.providers.get(provider)
+      if (!arbProvider) {
+        arbProvider = new ArbitrumProvider(provider, undefined, cache)
+        this.providers.set(provider, arbProvider)
+      }
+    }
+    if (cache && arbProvider.cache !== cache) {
+      throw new ArbSdkError(
+        'The ArbitrumProvider of this provider already has a different cache.'
+      )
+    }
+    return arbProvider
+  }
+
+  public override async send(
+    method: string,
+    params: Array<any> = []
+  ): Promise<any> {
+    if (!this.cache || !RpcResultCache.isCacheable(method)) {
+      return await super.send(method, params)
+    }
+    return await this.cache.send(
+      (await this.getNetwork()).chainId,
+      method,
+      params,
+      (m, p) => super.send(m, p),
+      () => HeadTracker.forProvider(this).getBlockNumber()
+    )
+  }
+
+  /**
+   * The network of a provider does not change, so it is only detected once
+   */
+  public override detectNetwork(): Promise<Network> {
+    if (!this.detectedNetwork) {
+      this.detectedNetwork = super.detectNetwork().catch(err => {
+        this.detectedNetwork = undefined
+        throw err
+      })
+    }
+    return this.detectedNetwork
   }
 
   static override getFormatter(): Formatter {
@@ -57,6 +57,7 @@ import { ArbAddressTable } from '../abi/ArbAddressTable'
 
 import { ARB_ADDRESS_TABLE_ADDRESS } from '../dataEntities/constants'
 import { ArbSdkError } from '../dataEntities/errors'
+import { connectContract } from './contractCache'
 
 type PrimativeType = string | number | boolean | BigNumber
 type PrimativeOrPrimativeArray = PrimativeType | PrimativeType[]
@@ -76,7 +77,8 @@ export const getAddressIndex = (() => {
     }
     arbAddressTable =
       arbAddressTable ||
-      ArbAddressTable__factory.connect(
+      connectContract(
+        ArbAddressTable__factory,
         ARB_ADDRESS_TABLE_ADDRESS,
         signerOrProvider
       )
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { Provider } from '@ethersproject/abstract-provider'
+import { Signer } from '@ethersproject/abstract-signer'
+import { Contract } from '@ethersproject/contracts'
+import { Interface } from '@ethersproject/abi'
+
+import { LruCache } from './lruCache'
+
+/**
+ * The static members of a typechain contract factory
+ */
+type ContractFactory<TContract extends Contract> = {
+  createInterface(): Interface
+  connect(address: string, signerOrProvider: Signer | Provider): TContract
+}
+
+// max number of contracts pooled per signer or provider, across all factories
+const MAX_CONTRACTS_PER_RUNNER = 1000
+
+const interfaces = new WeakMap<object, Interface>()
+// pooled contracts are keyed by factory id and lower case address
+const factoryIds = new WeakMap<object, number>()
+let nextFactoryId = 0
+const contracts = new WeakMap<Signer | Provider, LruCache<string, Contract>>()
+
+/**
+ * Get the interface of a typechain factory. The ABI is only parsed once per factory,
+ * rather than on every createInterface call
+ * @param factory
+ * @returns
+ */
+export const getInterface = <TInterface extends Interface>(factory: {
+  createInterface(): TInterface
+}): TInterface => {
+  let iFace = interfaces.get(factory) as TInterface | undefined
+  if (!iFace) {
+    iFace = factory.createInterface()
+    interfaces.set(factory, iFace)
+  }
+  return iFace
+}
+
+/**
+ * Create a new contract from a typechain factory, the same as factory.connect but
+ * reusing the factory's cached interface rather than parsing the ABI.
+ * Use this for contracts that are handed to users, who may add listeners to them
+ * @param factory
+ * @param address
+ * @param signerOrProvider
+ * @returns
+ */
+export const createContract = <TContract extends Contract>(
+  factory: ContractFactory<TContract>,
+  address: string,
+  signerOrProvider: Signer | Provider
+): TContract =>
+  new Contract(address, getInterface(factory), signerOrProvider) as TContract
+
+/**
+ * Get a contract from a typechain factory, the same as factory.connect. Contracts are
+ * pooled by (factory, address, signer or provider), and new contracts reuse the factory's
+ * cached interface, so repeated connects neither parse the ABI nor allocate a new contract.
+ * Pooled contracts are shared across the process, so they are only for internal calls.
+ * Contracts returned to users should come from createContract, so that listeners they
+ * add are not shared
+ * @param factory
+ * @param address
+ * @param signerOrProvider
+ * @returns
+ */
+export const connectContract = <TContract extends Contract>(
+  factory: ContractFactory<TContract>,
+  address: string,
+  signerOrProvider: Signer | Provider
+): TContract => {
+  let pool = contracts.get(signerOrProvider)
+  if (!pool) {
+    pool = new LruCache(MAX_CONTRACTS_PER_RUNNER)
+    contracts.set(signerOrProvider, pool)
+  }
+  let factoryId = factoryIds.get(factory)
+  if (factoryId === undefined) {
+    factoryId = nextFactoryId++
+    factoryIds.set(factory, factoryId)
+  }
+
+  const key = `${factoryId}:${address.toLowerCase()}`
+  let contract = pool.get(key) as TContract | undefined
+  if (!contract) {
+    contract = createContract(factory, address, signerOrProvider)
+    pool.set(key, contract)
+  }
+  return contract
+}
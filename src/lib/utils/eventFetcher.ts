@@ -16,12 +16,34 @@
 /* eslint-env node */
 'use strict'
 
-import { Provider, BlockTag, Filter } from '@ethersproject/abstract-provider'
+import {
+  Provider,
+  BlockTag,
+  Filter,
+  Log,
+} from '@ethersproject/abstract-provider'
 import { Contract, Event } from '@ethersproject/contracts'
-import { constants } from 'ethers'
+import { BigNumber, constants, utils } from 'ethers'
 import { TypedEvent, TypedEventFilter } from '../abi/common'
-import { EventArgs, TypeChainContractFactory } from '../dataEntities/event'
+import {
+  EventArgs,
+  LogDecoder,
+  TypeChainContractFactory,
+  getLogDecoder,
+} from '../dataEntities/event'
+import {
+  ArbSdkError,
+  errorText,
+  isRateLimitError,
+} from '../dataEntities/errors'
+import { SignerProviderUtils } from '../dataEntities/signerOrProvider'
+import { isDefined, wait } from './lib'
+import { LogCache } from './logCache'
 
+/**
+ * A fetched log along with its decoded event. The event args are only decoded
+ * when `event` is first accessed.
+ */
 export type FetchedEvent<TEvent extends Event> = {
   event: EventArgs<TEvent>
   topic: string
@@ -29,11 +51,111 @@ export type FetchedEvent<TEvent extends Event> = {
   blockNumber: number
   blockHash: string
   transactionHash: string
+  logIndex: number
   address: string
   topics: string[]
   data: string
 }
 
+/**
+ * Position of the last consumed log in an event stream. Streams resumed
+ * from a cursor only return logs after this position.
+ */
+export type EventCursor = {
+  blockNumber: number
+  logIndex: number
+}
+
+/**
+ * A page of events returned from an event stream, along with the cursor
+ * that can be used to resume the stream after this page
+ */
+export type EventPage<T> = {
+  events: T[]
+  cursor: EventCursor
+}
+
+export type EventStreamOptions = EventFetcherOptions & {
+  /**
+   * Resume a previous stream after this position
+   */
+  cursor?: EventCursor
+}
+
+/**
+ * Options controlling how large block ranges are split into several getLogs requests
+ */
+export type EventFetcherOptions = {
+  /**
+   * Number of blocks to request in each getLogs call. If not provided the whole range is
+   * requested at once, and only split into pages if the provider rejects it for
+   * returning too many results or covering too many blocks.
+   */
+  pageSize?: number
+  /**
+   * Max page size reached when growing the page size after sparse pages. Defaults to 1m blocks
+   */
+  maxPageSize?: number
+  /**
+   * Pages that return fewer logs than this are considered sparse, and the page size is
+   * doubled for subsequent pages. Defaults to 1000
+   */
+  sparseThreshold?: number
+  /**
+   * Max number of getLogs requests in flight at once. Defaults to 4
+   */
+  concurrency?: number
+  /**
+   * Number of times a page is retried, with an increasing delay, on errors other than
+   * provider result limits, such as rate limits. Defaults to 2
+   */
+  retries?: number
+  /**
+   * Serve blocks that have already been fetched from this cache, and add newly
+   * fetched finalized blocks to it. Only the missing ranges are requested.
+   */
+  cache?: LogCache
+}
+
+const DEFAULT_STREAM_PAGE_SIZE = 10000
+const DEFAULT_MAX_PAGE_SIZE = 1000000
+const DEFAULT_SPARSE_THRESHOLD = 1000
+const DEFAULT_CONCURRENCY = 4
+const DEFAULT_RETRIES = 2
+const RETRY_DELAY_MS = 250
+
+/**
+ * Providers reject getLogs requests that would return too many results or that cover too
+ * many blocks, with a variety of messages. These errors can be resolved by requesting a smaller range.
+ */
+const isLogLimitError = (err: unknown): boolean => {
+  if (isRateLimitError(err)) return false
+  const text = errorText(err)
+  return [
+    // eg. infura and alchemy, code -32005
+    /query returned more than \d+ results/i,
+    /block range (is )?(too (large|wide)|exceed)/i,
+    /(exceeds?|max(imum)?) .*block range/i,
+    /range .*(too large|too wide|exceed)/i,
+    /log response size exceeded/i,
+    /too many (logs|results|blocks)/i,
+  ].some(r => r.test(text))
+}
+
+/**
+ * Orders logs by block number, then log index
+ */
+const compareLogs = (a: EventCursor, b: EventCursor) =>
+  a.blockNumber - b.blockNumber || a.logIndex - b.logIndex
+
+/**
+ * A page of logs, covering blocks up to and including toBlock
+ */
+type LogPage = {
+  logs: Log[]
+  toBlock: BlockTag
+}
+
 // I'm not sure why, but I wasn't able to get the getEvents function to properly
 // infer the Event return type. It would always infer it as TypedEvent<any, any>
 // instead of the strong typed event that should be available. This type correctly
@@ -45,13 +167,23 @@ type TEventOf<T> = T extends TypedEventFilter<infer TEvent> ? TEvent : never
  * Fetches and parses blockchain logs
  */
 export class EventFetcher {
-  public constructor(public readonly provider: Provider) {}
+  /**
+   * @param provider
+   * @param options Default options for splitting large ranges into several getLogs requests
+   */
+  public constructor(
+    public readonly provider: Provider,
+    public readonly options?: EventFetcherOptions
+  ) {}
 
   /**
    * Fetch logs and parse logs
+   * Large ranges are split into pages, see EventFetcherOptions. The results
+   * are ordered by block number and log index.
    * @param contractFactory A contract factory for generating a contract of type TContract at the addr
    * @param topicGenerator Generator function for creating
    * @param filter Block and address filter parameters
+   * @param options Overrides the default paging options of this fetcher
    * @returns
    */
   public async getEvents<
@@ -64,12 +196,10 @@ export class EventFetcher {
       fromBlock: BlockTag
       toBlock: BlockTag
       address?: string
-    }
+    },
+    options?: EventFetcherOptions
   ): Promise<FetchedEvent<TEventOf<TEventFilter>>[]> {
-    const contract = contractFactory.connect(
-      filter.address || constants.AddressZero,
-      this.provider
-    )
+    const contract = this.getFilterContract(contractFactory, filter.address)
     const eventFilter = topicGenerator(contract)
     const fullFilter: Filter = {
       ...eventFilter,
@@ -77,24 +207,294 @@ export class EventFetcher {
       fromBlock: filter.fromBlock,
       toBlock: filter.toBlock,
     }
-    const logs = await this.provider.getLogs(fullFilter)
+
+    const logs: Log[] = []
+    for await (const page of this.getLogPages(fullFilter, {
+      ...this.options,
+      ...options,
+    })) {
+      logs.push(...page.logs)
+    }
+
+    return this.parseLogs(getLogDecoder(contractFactory), logs)
+  }
+
+  /**
+   * Fetch and parse logs as a stream of pages, so that large ranges can be processed without
+   * holding all of the events in memory. Only a bounded number of pages (options.concurrency)
+   * are fetched ahead of the page being consumed.
+   * Each page contains a cursor that can be passed back in the options to resume the stream
+   * after that page. A cursor can also be constructed from the blockNumber and logIndex of
+   * the last event that was processed.
+   * @param contractFactory A contract factory for generating a contract of type TContract at the addr
+   * @param topicGenerator Generator function for creating
+   * @param filter Block and address filter parameters
+   * @param options Overrides the default paging options of this fetcher. Page size defaults to 10000 blocks.
+   * @returns
+   */
+  public async *streamEvents<
+    TContract extends Contract,
+    TEventFilter extends TypedEventFilter<TypedEvent>
+  >(
+    contractFactory: TypeChainContractFactory<TContract>,
+    topicGenerator: (t: TContract) => TEventFilter,
+    filter: {
+      fromBlock: BlockTag
+      toBlock: BlockTag
+      address?: string
+    },
+    options?: EventStreamOptions
+  ): AsyncGenerator<EventPage<FetchedEvent<TEventOf<TEventFilter>>>> {
+    const contract = this.getFilterContract(contractFactory, filter.address)
+    const eventFilter = topicGenerator(contract)
+    const decoder = getLogDecoder(contractFactory)
+    const cursor = options?.cursor
+
+    let fromBlock = await this.resolveBlockTag(filter.fromBlock)
+    if (cursor) fromBlock = Math.max(fromBlock, cursor.blockNumber)
+    const fullFilter: Filter = {
+      ...eventFilter,
+      address: filter.address,
+      fromBlock: fromBlock,
+      toBlock: await this.resolveBlockTag(filter.toBlock),
+    }
+
+    for await (const page of this.getLogPages(fullFilter, {
+      pageSize: DEFAULT_STREAM_PAGE_SIZE,
+      ...this.options,
+      ...options,
+    })) {
+      const logs = cursor
+        ? page.logs.filter(l => compareLogs(l, cursor) > 0)
+        : page.logs
+
+      yield {
+        events: this.parseLogs(decoder, logs) as FetchedEvent<
+          TEventOf<TEventFilter>
+        >[],
+        cursor: {
+          blockNumber: page.toBlock as number,
+          logIndex: Number.MAX_SAFE_INTEGER,
+        },
+      }
+    }
+  }
+
+  /**
+   * A contract that is only used to generate filters. Built from the factory's cached
+   * interface, rather than connecting through the factory which parses the abi each time.
+   */
+  private getFilterContract<TContract extends Contract>(
+    contractFactory: TypeChainContractFactory<TContract>,
+    address?: string
+  ): TContract {
+    return new Contract(
+      address || constants.AddressZero,
+      getLogDecoder(contractFactory).iFace,
+      this.provider
+    ) as TContract
+  }
+
+  private parseLogs<TEvent extends Event>(
+    decoder: LogDecoder,
+    logs: Log[]
+  ): FetchedEvent<TEvent>[] {
     return logs
       .filter(l => l.removed === false)
       .map(l => {
-        const pLog = contract.interface.parseLog(l)
+        const fragment = decoder.getFragment(l.topics[0])
+        if (!fragment) {
+          throw new ArbSdkError(`No event found for topic ${l.topics[0]}`)
+        }
 
-        return {
-          event: pLog.args,
-          topic: pLog.topic,
-          name: pLog.name,
+        let args: EventArgs<TEvent> | undefined
+        const fetched = {
+          topic: l.topics[0],
+          name: fragment.name,
           blockNumber: l.blockNumber,
           blockHash: l.blockHash,
           transactionHash: l.transactionHash,
+          logIndex: l.logIndex,
 
           address: l.address,
           topics: l.topics,
           data: l.data,
         }
-      }) as FetchedEvent<TEventOf<TEventFilter>>[]
+        // decode on first access, enumerable so that the event is kept when spreading
+        return Object.defineProperty(fetched, 'event', {
+          enumerable: true,
+          get: () => {
+            if (!args) {
+              args = decoder.decodeArgs(l, fragment) as EventArgs<TEvent>
+            }
+            return args
+          },
+        }) as FetchedEvent<TEvent>
+      })
+  }
+
+  /**
+   * Fetch the logs matching the filter as a series of ordered pages.
+   * At most options.concurrency pages are requested ahead of the page being consumed.
+   */
+  protected async *getLogPages(
+    filter: Filter,
+    options: EventFetcherOptions
+  ): AsyncGenerator<LogPage> {
+    if (!options.pageSize && !options.cache) {
+      // try the whole range at once, and only page if the provider rejects it
+      let logs: Log[] | undefined
+      try {
+        logs = await this.getLogsWithRetry(filter, options)
+      } catch (err) {
+        if (!isLogLimitError(err)) throw err
+      }
+      if (logs) {
+        yield { logs: logs.sort(compareLogs), toBlock: filter.toBlock! }
+        return
+      }
+    }
+
+    const fromBlock = await this.resolveBlockTag(filter.fromBlock)
+    const toBlock = await this.resolveBlockTag(filter.toBlock)
+    const maxPageSize = options.maxPageSize || DEFAULT_MAX_PAGE_SIZE
+    const sparseThreshold = options.sparseThreshold || DEFAULT_SPARSE_THRESHOLD
+    const concurrency = options.concurrency || DEFAULT_CONCURRENCY
+    // without a cache the whole range has already been tried, so start from half of it
+    const rangeSize = toBlock - fromBlock + 1
+    const state = {
+      pageSize:
+        options.pageSize ||
+        Math.max(1, options.cache ? rangeSize : Math.ceil(rangeSize / 2)),
+    }
+    const cache = options.cache
+    const cacheParams = cache && {
+      chainId: await SignerProviderUtils.getChainId(this.provider),
+      latestBlock: await this.provider.getBlockNumber(),
+    }
+
+    // each completed request adjusts the size of the pages that are yet to be requested:
+    // sparse results grow the page size, results limits shrink it to the size that succeeded
+    const onRangeFetched = (size: number, logCount: number, split: boolean) => {
+      if (split) state.pageSize = Math.min(state.pageSize, size)
+      else if (logCount < sparseThreshold)
+        state.pageSize = Math.min(
+          Math.max(state.pageSize, size * 2),
+          maxPageSize
+        )
+    }
+
+    let next = fromBlock
+    const inFlight: Promise<LogPage>[] = []
+    const requestPages = () => {
+      while (inFlight.length < concurrency && next <= toBlock) {
+        const end = Math.min(next + state.pageSize - 1, toBlock)
+        const fetchLogs = (range: { fromBlock: number; toBlock: number }) =>
+          this.getLogsInRange(
+            filter,
+            range.fromBlock,
+            range.toBlock,
+            options,
+            onRangeFetched
+          )
+        const range = { fromBlock: next, toBlock: end }
+        const page = (
+          cache && cacheParams
+            ? cache.getLogs(
+                cacheParams.chainId,
+                filter,
+                range,
+                cacheParams.latestBlock,
+                fetchLogs,
+                concurrency
+              )
+            : fetchLogs(range)
+        ).then(logs => ({ logs: logs.sort(compareLogs), toBlock: end }))
+        // pages are awaited in order, so avoid unhandled rejections for
+        // pages that fail while an earlier one is still being awaited
+        page.catch(() => undefined)
+        inFlight.push(page)
+        next = end + 1
+      }
+    }
+
+    requestPages()
+    while (inFlight.length > 0) {
+      const page = await inFlight.shift()!
+      requestPages()
+      yield page
+    }
+  }
+
+  /**
+   * Get the logs in a block range, bisecting the range if the provider rejects it
+   * for returning too many results
+   */
+  private async getLogsInRange(
+    filter: Filter,
+    fromBlock: number,
+    toBlock: number,
+    options: EventFetcherOptions,
+    onRangeFetched: (size: number, logCount: number, split: boolean) => void,
+    split = false
+  ): Promise<Log[]> {
+    try {
+      const logs = await this.getLogsWithRetry(
+        { ...filter, fromBlock, toBlock },
+        options
+      )
+      onRangeFetched(toBlock - fromBlock + 1, logs.length, split)
+      return logs
+    } catch (err) {
+      if (!isLogLimitError(err) || fromBlock >= toBlock) throw err
+
+      const mid = Math.floor((fromBlock + toBlock) / 2)
+      const left = await this.getLogsInRange(
+        filter,
+        fromBlock,
+        mid,
+        options,
+        onRangeFetched,
+        true
+      )
+      const right = await this.getLogsInRange(
+        filter,
+        mid + 1,
+        toBlock,
+        options,
+        onRangeFetched,
+        true
+      )
+      return left.concat(right)
+    }
+  }
+
+  private async getLogsWithRetry(
+    filter: Filter,
+    options: EventFetcherOptions
+  ): Promise<Log[]> {
+    const retries = isDefined(options.retries)
+      ? options.retries
+      : DEFAULT_RETRIES
+    for (let attempt = 0; ; attempt++) {
+      try {
+        return await this.provider.getLogs(filter)
+      } catch (err) {
+        if (isLogLimitError(err) || attempt >= retries) throw err
+        await wait(RETRY_DELAY_MS * 2 ** attempt)
+      }
+    }
+  }
+
+  private async resolveBlockTag(blockTag?: BlockTag): Promise<number> {
+    if (typeof blockTag === 'number') return blockTag
+    if (blockTag === 'earliest') return 0
+    if (!isDefined(blockTag) || blockTag === 'latest')
+      return await this.provider.getBlockNumber()
+    if (utils.isHexString(blockTag)) return BigNumber.from(blockTag).toNumber()
+
+    const block = await this.provider.getBlock(blockTag)
+    if (!block) throw new ArbSdkError(`Block not found. ${blockTag}`)
+    return block.number
   }
 }
@@ -0,0 +1,195 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+// Building blocks for the codecs that scripts/genFastCodecs.js generates into
+// src/lib/abi/fastCodecs.ts. They work directly on hex strings rather than
+// walking generic coders over byte arrays. Decoders take the 0x prefixed hex
+// data and a position, which is an index into that string rather than a byte
+// offset. Encoders return unprefixed hex.
+
+import { getAddress } from '@ethersproject/address'
+import { BigNumber } from '@ethersproject/bignumber'
+import { BytesLike, hexlify, isHexString } from '@ethersproject/bytes'
+
+import { ArbSdkError } from '../dataEntities/errors'
+
+/**
+ * An unsigned integer to encode. BigNumbers are accepted as they are, so that
+ * callers holding BigNumbers dont need to convert them first
+ */
+export type UintLike = bigint | number | { toHexString(): string }
+
+const WORD_LENGTH = 64
+const ZERO_WORD = '0'.repeat(WORD_LENGTH)
+const ONE_WORD = ZERO_WORD.slice(1) + '1'
+const ADDRESS_PADDING = '0'.repeat(24)
+
+/**
+ * Check that a value is hex data, and lower case it as ethers does
+ * @param value
+ * @returns
+ */
+export const hexData = (value: string): string => {
+  if (!isHexString(value) || value.length % 2 !== 0) {
+    throw new ArbSdkError(`Invalid hex data: ${value}`)
+  }
+  return value.toLowerCase()
+}
+
+/**
+ * Check that a log has the topic and number of topics of an event
+ * @param topics
+ * @param topic
+ * @param topicCount
+ * @param eventName
+ */
+export const checkTopics = (
+  topics: string[],
+  topic: string,
+  topicCount: number,
+  eventName: string
+): void => {
+  if (topics.length !== topicCount || topics[0].toLowerCase() !== topic) {
+    throw new ArbSdkError(`Log is not a ${eventName} event`)
+  }
+}
+
+const readWord = (data: string, pos: number): string => {
+  if (pos + WORD_LENGTH > data.length) {
+    throw new ArbSdkError(`Data too short to read word at ${(pos - 2) / 2}`)
+  }
+  return data.slice(pos, pos + WORD_LENGTH)
+}
+
+export const decodeBigInt = (
+  data: string,
+  pos: number,
+  bits: number
+): bigint => BigInt('0x' + readWord(data, pos).slice(WORD_LENGTH - bits / 4))
+
+/**
+ * Decode an integer that fits in a number, ie. of at most 48 bits
+ */
+export const decodeNumber = (data: string, pos: number, bits: number): number =>
+  parseInt(readWord(data, pos).slice(WORD_LENGTH - bits / 4), 16)
+
+export const decodeBool = (data: string, pos: number): boolean =>
+  readWord(data, pos) !== ZERO_WORD
+
+export const decodeAddress = (data: string, pos: number): string =>
+  getAddress('0x' + readWord(data, pos).slice(24))
+
+export const decodeFixedBytes = (
+  data: string,
+  pos: number,
+  size: number
+): string => '0x' + readWord(data, pos).slice(0, size * 2)
+
+/**
+ * Decode the offset of a dynamic value
+ * @returns The offset as a number of hex characters
+ */
+export const decodeOffset = (data: string, pos: number): number => {
+  const offset = parseInt(readWord(data, pos), 16)
+  if (!Number.isSafeInteger(offset)) {
+    throw new ArbSdkError(`Invalid offset at ${(pos - 2) / 2}`)
+  }
+  return offset * 2
+}
+
+/**
+ * Decode the length of a dynamic value, checking that the data is long enough to hold it
+ * @param elementLength Hex characters taken by each element
+ */
+export const decodeLength = (
+  data: string,
+  pos: number,
+  elementLength: number
+): number => {
+  const length = parseInt(readWord(data, pos), 16)
+  if (
+    !Number.isSafeInteger(length) ||
+    pos + WORD_LENGTH + length * elementLength > data.length
+  ) {
+    throw new ArbSdkError(`Invalid length at ${(pos - 2) / 2}`)
+  }
+  return length
+}
+
+export const decodeBytes = (data: string, pos: number): string => {
+  const start = pos + WORD_LENGTH
+  return '0x' + data.slice(start, start + decodeLength(data, pos, 2) * 2)
+}
+
+/**
+ * Convert a decoded integer to a BigNumber, for the public types that hold ethers values
+ */
+export const toBigNumber = (value: bigint | number): BigNumber =>
+  BigNumber.from(typeof value === 'bigint' ? '0x' + value.toString(16) : value)
+
+export const encodeUint = (value: UintLike, bits: number): string => {
+  let hex: string
+  if (typeof value === 'bigint') {
+    if (value < 0) throw new ArbSdkError(`Negative uint${bits}: ${value}`)
+    hex = value.toString(16)
+  } else if (typeof value === 'number') {
+    if (!Number.isSafeInteger(value) || value < 0) {
+      throw new ArbSdkError(`Invalid uint${bits}: ${value}`)
+    }
+    hex = value.toString(16)
+  } else {
+    hex = value.toHexString()
+    if (hex[0] === '-') throw new ArbSdkError(`Negative uint${bits}: ${hex}`)
+    hex = hex.slice(2)
+  }
+  if (hex.length > bits / 4) {
+    throw new ArbSdkError(`Value out of range for uint${bits}: 0x${hex}`)
+  }
+  return hex.padStart(WORD_LENGTH, '0')
+}
+
+export const encodeBool = (value: boolean): string =>
+  value ? ONE_WORD : ZERO_WORD
+
+/**
+ * Encode an address. Unlike ethers the checksum of mixed case addresses is not verified,
+ * so callers should check addresses that come from users with getAddress first
+ */
+export const encodeAddress = (address: string): string => {
+  if (!/^0x[0-9a-fA-F]{40}$/.test(address)) {
+    throw new ArbSdkError(`Invalid address: ${address}`)
+  }
+  return ADDRESS_PADDING + address.slice(2).toLowerCase()
+}
+
+const toHex = (value: BytesLike): string =>
+  typeof value === 'string' ? hexData(value).slice(2) : hexlify(value).slice(2)
+
+export const encodeFixedBytes = (value: BytesLike, size: number): string => {
+  const hex = toHex(value)
+  if (hex.length !== size * 2) {
+    throw new ArbSdkError(`Invalid bytes${size}: 0x${hex}`)
+  }
+  return hex.padEnd(WORD_LENGTH, '0')
+}
+
+export const encodeBytes = (value: BytesLike): string => {
+  const hex = toHex(value)
+  const paddedLength = Math.ceil(hex.length / WORD_LENGTH) * WORD_LENGTH
+  return encodeUint(hex.length / 2, 256) + hex.padEnd(paddedLength, '0')
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { promises as fs } from 'fs'
+import * as path from 'path'
+import { id } from '@ethersproject/hash'
+
+import { BlockRange, LogCacheChunk, LogCacheStore } from './logCache'
+
+const CHUNK_FILE = /^(\d+)-(\d+)\.json$/
+const KEY_FILE = 'key.json'
+
+/**
+ * Persists log cache chunks in a directory, so that fetched ranges survive restarts.
+ * Each filter has a sub directory holding one json file per chunk, named by its block
+ * range, so adding a chunk never rewrites the ones already stored and the stored ranges
+ * are known without reading the files.
+ * Node only, so it is not exported from the package index, import it from this module directly.
+ */
+export class FileLogCacheStore implements LogCacheStore {
+  /**
+   * @param directory Directory to store the cache files in, created if it does not exist
+   */
+  public constructor(public readonly directory: string) {}
+
+  public async getRanges(key: string): Promise<BlockRange[]> {
+    const dir = this.getDir(key)
+    // guard against hash collisions
+    if ((await this.readJson(path.join(dir, KEY_FILE))) !== key) return []
+
+    const ranges: BlockRange[] = []
+    for (const file of await fs.readdir(dir)) {
+      const match = CHUNK_FILE.exec(file)
+      if (match) {
+        ranges.push({ fromBlock: Number(match[1]), toBlock: Number(match[2]) })
+      }
+    }
+    return ranges
+  }
+
+  public async getChunks(
+    key: string,
+    range: BlockRange
+  ): Promise<LogCacheChunk[]> {
+    const overlapping = (await this.getRanges(key)).filter(
+      r => r.fromBlock <= range.toBlock && range.fromBlock <= r.toBlock
+    )
+    const chunks = await Promise.all(
+      overlapping.map(r => this.readJson(this.getChunkPath(key, r)))
+    )
+    return chunks.filter(c => c !== undefined) as LogCacheChunk[]
+  }
+
+  public async addChunk(key: string, chunk: LogCacheChunk): Promise<void> {
+    const dir = this.getDir(key)
+    await fs.mkdir(dir, { recursive: true })
+    try {
+      await fs.writeFile(path.join(dir, KEY_FILE), JSON.stringify(key), {
+        flag: 'wx',
+      })
+    } catch (err) {
+      if ((err as { code?: string }).code !== 'EEXIST') throw err
+      // the directory belongs to another key with the same hash
+      if ((await this.readJson(path.join(dir, KEY_FILE))) !== key) return
+    }
+    await this.writeJson(this.getChunkPath(key, chunk.range), chunk)
+  }
+
+  private async readJson(filePath: string): Promise<any | undefined> {
+    try {
+      return JSON.parse(await fs.readFile(filePath, 'utf8'))
+    } catch (err) {
+      if ((err as { code?: string }).code === 'ENOENT') return undefined
+      throw err
+    }
+  }
+
+  private async writeJson(filePath: string, value: unknown): Promise<void> {
+    // write to a temporary file first so that a crash never leaves a partial chunk
+    const tmpPath = `${filePath}.${process.pid}.tmp`
+    await fs.writeFile(tmpPath, JSON.stringify(value))
+    await fs.rename(tmpPath, filePath)
+  }
+
+  private getDir(key: string) {
+    return path.join(this.directory, id(key).slice(2))
+  }
+
+  private getChunkPath(key: string, range: BlockRange) {
+    return path.join(
+      this.getDir(key),
+      `${range.fromBlock}-${range.toBlock}.json`
+    )
+  }
+}
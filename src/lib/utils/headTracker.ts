@@ -0,0 +1,163 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { Provider } from '@ethersproject/abstract-provider'
+import { BigNumber } from '@ethersproject/bignumber'
+
+import { ArbSdkError } from '../dataEntities/errors'
+
+/**
+ * The parts of the latest block that are commonly needed
+ */
+export type ChainHead = {
+  number: number
+  hash: string
+  timestamp: number
+  baseFeePerGas?: BigNumber | null
+}
+
+export type HeadTrackerOptions = {
+  /**
+   * Max age (ms) of a head served from memory. Defaults to 1000
+   */
+  maxStalenessMs?: number
+}
+
+const DEFAULT_MAX_STALENESS_MS = 1000
+
+/**
+ * Serves the latest block of a provider from memory to all of its users. The head is
+ * refetched once it is older than the staleness bound, and fetches in flight at the same
+ * time are shared. Calling follow keeps the head up to date from the provider's block
+ * events instead, so that reads within the staleness bound never wait on a request.
+ * Since the tracker is shared, follow is reference counted: the block events are only
+ * unsubscribed once every follow has been matched by an unfollow.
+ */
+export class HeadTracker {
+  private static readonly trackers = new WeakMap<Provider, HeadTracker>()
+
+  private head?: ChainHead
+  private fetchedAt = 0
+  private fetching?: Promise<ChainHead>
+  private followers = 0
+
+  /**
+   * @param provider
+   * @param options
+   */
+  public constructor(
+    public readonly provider: Provider,
+    public options?: HeadTrackerOptions
+  ) {}
+
+  /**
+   * Get the tracker shared by all users of a provider
+   * @param provider
+   * @param options If provided, replaces the options of the shared tracker
+   * @returns
+   */
+  public static forProvider(
+    provider: Provider,
+    options?: HeadTrackerOptions
+  ): HeadTracker {
+    let tracker = this.trackers.get(provider)
+    if (!tracker) {
+      tracker = new HeadTracker(provider, options)
+      this.trackers.set(provider, tracker)
+    } else if (options) tracker.options = options
+    return tracker
+  }
+
+  /**
+   * Get the latest block
+   * @param maxStalenessMs Overrides the max age of a head served from memory
+   * @returns
+   */
+  public async getHead(maxStalenessMs?: number): Promise<ChainHead> {
+    const configured =
+      typeof maxStalenessMs === 'number'
+        ? maxStalenessMs
+        : this.options?.maxStalenessMs
+    const maxAge =
+      typeof configured === 'number' ? configured : DEFAULT_MAX_STALENESS_MS
+    if (this.head && Date.now() - this.fetchedAt <= maxAge) return this.head
+    return await this.fetchHead()
+  }
+
+  public async getBlockNumber(maxStalenessMs?: number): Promise<number> {
+    return (await this.getHead(maxStalenessMs)).number
+  }
+
+  public async getTimestamp(maxStalenessMs?: number): Promise<number> {
+    return (await this.getHead(maxStalenessMs)).timestamp
+  }
+
+  public async getBaseFee(maxStalenessMs?: number): Promise<BigNumber> {
+    const baseFee = (await this.getHead(maxStalenessMs)).baseFeePerGas
+    if (!baseFee) {
+      throw new ArbSdkError(
+        'Latest block did not contain base fee, ensure provider is connected to a network that supports EIP 1559.'
+      )
+    }
+    return baseFee
+  }
+
+  /**
+   * Refetch the head whenever the provider reports a new block, until unfollow is called
+   */
+  public follow(): void {
+    if (this.followers === 0) this.provider.on('block', this.blockListener)
+    this.followers++
+  }
+
+  /**
+   * Undo a call to follow. Once every follower has unfollowed, the head is refetched on demand
+   */
+  public unfollow(): void {
+    if (this.followers === 0) return
+    this.followers--
+    if (this.followers === 0) this.provider.off('block', this.blockListener)
+  }
+
+  private readonly blockListener = (blockNumber: number) => {
+    if (this.head && this.head.number >= blockNumber) return
+    // errors are ignored here, the next read refetches the head
+    this.fetchHead().catch(() => undefined)
+  }
+
+  private fetchHead(): Promise<ChainHead> {
+    if (!this.fetching) {
+      this.fetching = (async () => {
+        const block = await this.provider.getBlock('latest')
+        const head: ChainHead = {
+          number: block.number,
+          hash: block.hash,
+          timestamp: block.timestamp,
+          baseFeePerGas: block.baseFeePerGas,
+        }
+        // a lagging node behind a load balancer can return an older head
+        if (!this.head || head.number >= this.head.number) this.head = head
+        this.fetchedAt = Date.now()
+        return this.head
+      })().finally(() => {
+        this.fetching = undefined
+      })
+    }
+    return this.fetching
+  }
+}
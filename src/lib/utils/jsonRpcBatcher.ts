@@ -0,0 +1,317 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { Provider } from '@ethersproject/abstract-provider'
+import { JsonRpcProvider, TransactionReceipt } from '@ethersproject/providers'
+import { fetchJson } from 'ethers/lib/utils'
+
+import {
+  ArbSdkError,
+  errorText,
+  isRateLimitError,
+} from '../dataEntities/errors'
+
+export type JsonRpcBatcherOptions = {
+  /**
+   * Max number of requests in a single batch, larger batches are split. Defaults to 100
+   */
+  maxBatchSize?: number
+  /**
+   * How long (ms) to collect requests before sending them as one batch.
+   * Defaults to 0, which batches the requests issued in the same event loop tick
+   */
+  flushDelayMs?: number
+}
+
+const DEFAULT_MAX_BATCH_SIZE = 100
+// batches too large for the endpoint are split in half until they are this size
+const MIN_SPLIT_BATCH_SIZE = 10
+
+type QueuedRequest = {
+  method: string
+  params: Array<any>
+  resolve: (result: any) => void
+  reject: (err: unknown) => void
+}
+
+type JsonRpcResponse = {
+  id: number
+  result?: any
+  error?: { code: number; message: string; data?: any }
+}
+
+/**
+ * Endpoints reject batches that are too large with a 413, or with a JSON-RPC error
+ * for the whole batch. Only these can be resolved by sending smaller batches
+ */
+const isBatchTooLargeError = (err: unknown): boolean => {
+  if (isRateLimitError(err)) return false
+  const e = err as { status?: number }
+  if (e?.status === 413) return true
+  return [
+    // eg. geth "batch too large", alchemy "batch size is too large"
+    /batch.*(too (large|big|many)|size|limit|exceed)/i,
+    /(request entity|payload) too large/i,
+  ].some(r => r.test(errorText(err)))
+}
+
+/**
+ * The error a JSON-RPC provider throws for an error response
+ */
+const toJsonRpcError = (response: Partial<JsonRpcResponse>): Error => {
+  const error: any = new Error(response.error?.message || 'Batch not supported')
+  error.code = response.error?.code
+  error.data = response.error?.data
+  return error
+}
+
+/**
+ * Collects JSON-RPC requests issued within a short window and sends them to the
+ * provider's endpoint as a single JSON-RPC batch.
+ *
+ * Each request in a batch succeeds or fails on its own. If the endpoint rejects a batch
+ * as too large it is split in half and retried, and once small its requests are resent
+ * individually through the provider. Endpoints that do not support batches also get
+ * individual requests. Any other failure of the whole batch, such as rate limiting or a
+ * network error, is passed to all of its callers without resending. Providers without
+ * an http(s) connection, such as injected or websocket providers, and providers that
+ * override send always send individually.
+ */
+export class JsonRpcBatcher {
+  private static readonly batchers = new WeakMap<
+    JsonRpcProvider,
+    JsonRpcBatcher
+  >()
+
+  private queue: QueuedRequest[] = []
+  private flushScheduled = false
+  private nextId = 1
+
+  /**
+   * @param provider
+   * @param options
+   */
+  public constructor(
+    public readonly provider: JsonRpcProvider,
+    public readonly options?: JsonRpcBatcherOptions
+  ) {}
+
+  /**
+   * Get a batcher shared by all users of a provider. The options of the shared batcher
+   * are fixed when it is created, so to configure it call this before the provider is used.
+   * Throws if the shared batcher already exists with different options
+   * @param provider
+   * @param options
+   * @returns
+   */
+  public static forProvider(
+    provider: JsonRpcProvider,
+    options?: JsonRpcBatcherOptions
+  ): JsonRpcBatcher {
+    let batcher = this.batchers.get(provider)
+    if (!batcher) {
+      batcher = new JsonRpcBatcher(provider, options)
+      this.batchers.set(provider, batcher)
+    } else if (
+      options &&
+      !JsonRpcBatcher.sameOptions(batcher.options, options)
+    ) {
+      throw new ArbSdkError(
+        'The batcher of this provider was already created with different options.'
+      )
+    }
+    return batcher
+  }
+
+  private static sameOptions(
+    a: JsonRpcBatcherOptions | undefined,
+    b: JsonRpcBatcherOptions
+  ): boolean {
+    return (
+      a?.maxBatchSize === b.maxBatchSize && a?.flushDelayMs === b.flushDelayMs
+    )
+  }
+
+  /**
+   * Whether a provider can have a batcher. Only JSON-RPC providers can, others such
+   * as FallbackProviders have no JSON-RPC send
+   * @param provider
+   * @returns
+   */
+  public static isSupported(provider: Provider): provider is JsonRpcProvider {
+    return provider instanceof JsonRpcProvider
+  }
+
+  /**
+   * Whether requests are actually sent as batches, rather than individually.
+   * Providers that override send, eg. to add headers, retries or their own batching,
+   * are always sent to individually so that their send is not bypassed
+   */
+  public get canBatch(): boolean {
+    if (this.provider.send !== JsonRpcProvider.prototype.send) return false
+    const url = this.provider.connection?.url
+    return !!url && /^https?:\/\//i.test(url)
+  }
+
+  /**
+   * Queue a request to be sent in the next batch
+   * @param method
+   * @param params
+   * @returns The result of the request
+   */
+  public send(method: string, params: Array<any>): Promise<any> {
+    if (!this.canBatch) return this.provider.send(method, params)
+
+    return new Promise((resolve, reject) => {
+      this.queue.push({ method, params, resolve, reject })
+      this.scheduleFlush()
+    })
+  }
+
+  private scheduleFlush() {
+    if (this.flushScheduled) return
+    this.flushScheduled = true
+    setTimeout(() => this.flush(), this.options?.flushDelayMs || 0)
+  }
+
+  private flush() {
+    this.flushScheduled = false
+    const maxBatchSize = this.options?.maxBatchSize || DEFAULT_MAX_BATCH_SIZE
+    const queue = this.queue
+    this.queue = []
+
+    for (let i = 0; i < queue.length; i += maxBatchSize) {
+      // errors are passed to the individual callers, so this never rejects
+      this.sendBatch(queue.slice(i, i + maxBatchSize))
+    }
+  }
+
+  private async sendBatch(requests: QueuedRequest[]): Promise<void> {
+    if (requests.length === 1) {
+      await this.sendIndividually(requests[0])
+      return
+    }
+
+    const payload = requests.map(r => ({
+      jsonrpc: '2.0',
+      id: this.nextId++,
+      method: r.method,
+      params: r.params,
+    }))
+
+    let responses: JsonRpcResponse[]
+    try {
+      responses = await fetchJson(
+        this.provider.connection,
+        JSON.stringify(payload)
+      )
+    } catch (err) {
+      await this.batchFailed(requests, err)
+      return
+    }
+    if (!Array.isArray(responses)) {
+      // a single response for the whole batch
+      await this.batchFailed(requests, toJsonRpcError(responses), true)
+      return
+    }
+
+    const byId = new Map(responses.map(r => [r.id, r]))
+    await Promise.all(
+      requests.map(async (request, index) => {
+        const response = byId.get(payload[index].id)
+        if (response && !response.error) request.resolve(response.result)
+        // resend failures through the provider, so that callers receive the
+        // same errors they would without batching
+        else await this.sendIndividually(request)
+      })
+    )
+  }
+
+  /**
+   * Split batches that were too large, and send individually when batches are not
+   * supported. Otherwise the error is passed to every request in the batch
+   */
+  private async batchFailed(
+    requests: QueuedRequest[],
+    err: unknown,
+    unsupported = false
+  ) {
+    if (isBatchTooLargeError(err) && requests.length > MIN_SPLIT_BATCH_SIZE) {
+      const mid = Math.ceil(requests.length / 2)
+      await Promise.all([
+        this.sendBatch(requests.slice(0, mid)),
+        this.sendBatch(requests.slice(mid)),
+      ])
+    } else if (
+      isBatchTooLargeError(err) ||
+      (unsupported && !isRateLimitError(err))
+    ) {
+      await Promise.all(requests.map(r => this.sendIndividually(r)))
+    } else requests.forEach(r => r.reject(err))
+  }
+
+  private async sendIndividually(request: QueuedRequest) {
+    try {
+      request.resolve(await this.provider.send(request.method, request.params))
+    } catch (err) {
+      request.reject(err)
+    }
+  }
+}
+
+/**
+ * Fetch many transaction receipts at once. On JSON-RPC providers with an http(s)
+ * connection the requests are sent through the provider's shared batcher, so they are
+ * combined with any other requests made in the same tick. Otherwise they are fetched
+ * individually.
+ * @param provider
+ * @param txHashes
+ * @returns Receipts in the same order as the hashes, null for transactions that are not mined
+ */
+export const getTransactionReceipts = async (
+  provider: Provider,
+  txHashes: string[]
+): Promise<(TransactionReceipt | null)[]> => {
+  const batcher = JsonRpcBatcher.isSupported(provider)
+    ? JsonRpcBatcher.forProvider(provider)
+    : undefined
+  if (!batcher?.canBatch) {
+    return await Promise.all(
+      txHashes.map(async h => (await provider.getTransactionReceipt(h)) || null)
+    )
+  }
+
+  const raws = await Promise.all(
+    txHashes.map(h => batcher.send('eth_getTransactionReceipt', [h]))
+  )
+  // receipts of pending transactions have no block number
+  const mined = (raw: any) => !!raw && raw.blockNumber != null
+  if (!raws.some(mined)) return raws.map(() => null)
+
+  // the same block number, and max age, that the provider uses for confirmations
+  const jsonRpcProvider = batcher.provider
+  const blockNumber = await jsonRpcProvider._getInternalBlockNumber(
+    100 + 2 * jsonRpcProvider.pollingInterval
+  )
+  return raws.map(raw => {
+    if (!mined(raw)) return null
+    const receipt = jsonRpcProvider.formatter.receipt(raw)
+    receipt.confirmations = Math.max(blockNumber - receipt.blockNumber + 1, 1)
+    return receipt
+  })
+}
@@ -1,23 +1,43 @@
 import { Provider } from '@ethersproject/abstract-provider'
 import { TransactionReceipt } from '@ethersproject/providers'
 import { ArbSdkError } from '../dataEntities/errors'
+import { TransactionReceiptWaiter } from './receiptWaiter'
+import { HeadTracker } from './headTracker'
+import { getTransactionReceipts } from './jsonRpcBatcher'
 
-export const wait = (ms: number): Promise<void> =>
-  new Promise(res => setTimeout(res, ms))
+/**
+ * Resolves after ms, or rejects early if the signal is aborted
+ * @param ms
+ * @param signal
+ * @returns
+ */
+export const wait = (ms: number, signal?: AbortSignal): Promise<void> =>
+  new Promise((res, rej) => {
+    if (signal?.aborted) {
+      rej(new ArbSdkError('Wait aborted.'))
+      return
+    }
+    const onAbort = () => {
+      clearTimeout(timer)
+      rej(new ArbSdkError('Wait aborted.'))
+    }
+    const timer = setTimeout(() => {
+      signal?.removeEventListener('abort', onAbort)
+      res()
+    }, ms)
+    signal?.addEventListener('abort', onAbort)
+  })
 
 export const getBaseFee = async (provider: Provider) => {
-  const baseFee = (await provider.getBlock('latest')).baseFeePerGas
-  if (!baseFee) {
-    throw new ArbSdkError(
-      'Latest block did not contain base fee, ensure provider is connected to a network that supports EIP 1559.'
-    )
-  }
-  return baseFee
+  // the latest block is shared with other callers, within a short staleness bound
+  return await HeadTracker.forProvider(provider).getBaseFee()
 }
 
 /**
  * Waits for a transaction receipt if confirmations or timeout is provided
- * Otherwise tries to fetch straight away.
+ * Otherwise tries to fetch straight away. Receipts are fetched through the provider's
+ * shared JsonRpcBatcher, which can be configured with JsonRpcBatcher.forProvider
+ * before the provider is first used
  * @param provider
  * @param txHash
  * @param confirmations
@@ -31,24 +51,52 @@ export const getTransactionReceipt = async (
   timeout?: number
 ): Promise<TransactionReceipt | null> => {
   if (confirmations || timeout) {
-    try {
-      const receipt = await provider.waitForTransaction(
-        txHash,
-        confirmations,
-        timeout
-      )
-      return receipt || null
-    } catch (err) {
-      if ((err as Error).message.includes('timeout exceeded')) {
-        // return null
-        return null
-      } else throw err
-    }
+    // waits share a single block listener per provider
+    return await TransactionReceiptWaiter.forProvider(provider).waitForReceipt(
+      txHash,
+      confirmations ?? 1,
+      timeout
+    )
   } else {
-    const receipt = await provider.getTransactionReceipt(txHash)
-    return receipt || null
+    // concurrent lookups are combined into JSON-RPC batches
+    return (await getTransactionReceipts(provider, [txHash]))[0]
   }
 }
 
 export const isDefined = <T>(val: T | null | undefined): val is T =>
   typeof val !== 'undefined' && val !== null
+
+/**
+ * Maps over the items with an async function, running at most `concurrency`
+ * invocations at a time. Results are returned in the same order as the items.
+ * Rejects with the first error encountered, no new invocations are started after that.
+ * @param items
+ * @param concurrency Max number of invocations in flight at once
+ * @param fn
+ * @returns
+ */
+export const mapConcurrently = async <T, R>(
+  items: T[],
+  concurrency: number,
+  fn: (item: T, index: number) => Promise<R>
+): Promise<R[]> => {
+  const results: R[] = new Array(items.length)
+  let next = 0
+  let failed = false
+
+  const worker = async () => {
+    while (!failed && next < items.length) {
+      const index = next++
+      try {
+        results[index] = await fn(items[index], index)
+      } catch (err) {
+        failed = true
+        throw err
+      }
+    }
+  }
+
+  const workerCount = Math.max(1, Math.min(concurrency, items.length))
+  await Promise.all(Array.from({ length: workerCount }, () => worker()))
+  return results
+}
@@ -0,0 +1,341 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { Filter, Log } from '@ethersproject/abstract-provider'
+import { isDefined, mapConcurrently } from './lib'
+import { LruCache } from './lruCache'
+
+/**
+ * An inclusive range of blocks
+ */
+export type BlockRange = {
+  fromBlock: number
+  toBlock: number
+}
+
+/**
+ * Logs fetched for a block range of a single (chain, address, topics) filter
+ */
+export type LogCacheChunk = {
+  range: BlockRange
+  /**
+   * All the logs in the range, sorted by block number and log index
+   */
+  logs: Log[]
+}
+
+/**
+ * Storage backend for a LogCache. The logs of a filter are stored as chunks that are only
+ * ever added, never rewritten, so that storing a page costs the same however many pages
+ * are already stored. The chunks of a filter never overlap.
+ */
+export interface LogCacheStore {
+  /**
+   * Get the block ranges of the chunks stored for a filter, in any order
+   */
+  getRanges(key: string): Promise<BlockRange[]>
+  /**
+   * Get the chunks stored for a filter that overlap a block range, in any order
+   */
+  getChunks(key: string, range: BlockRange): Promise<LogCacheChunk[]>
+  addChunk(key: string, chunk: LogCacheChunk): Promise<void>
+}
+
+const overlaps = (a: BlockRange, b: BlockRange) =>
+  a.fromBlock <= b.toBlock && b.fromBlock <= a.toBlock
+
+/**
+ * Holds chunks in memory, evicting the least recently used filters once the total
+ * number of logs held is over the bound
+ */
+export class InMemoryLogCacheStore implements LogCacheStore {
+  private readonly entries: LruCache<
+    string,
+    { chunks: LogCacheChunk[]; logCount: number }
+  >
+
+  /**
+   * @param maxLogs Max number of logs to hold across all filters. Each chunk also
+   * counts as a log, so that empty ranges are bounded too. Defaults to 1m
+   */
+  public constructor(maxLogs = 1000000) {
+    this.entries = new LruCache(maxLogs, e => e.logCount + e.chunks.length)
+  }
+
+  public async getRanges(key: string): Promise<BlockRange[]> {
+    return (this.entries.get(key)?.chunks || []).map(c => c.range)
+  }
+
+  public async getChunks(
+    key: string,
+    range: BlockRange
+  ): Promise<LogCacheChunk[]> {
+    return (this.entries.get(key)?.chunks || []).filter(c =>
+      overlaps(c.range, range)
+    )
+  }
+
+  public async addChunk(key: string, chunk: LogCacheChunk): Promise<void> {
+    const entry = this.entries.get(key) || { chunks: [], logCount: 0 }
+    entry.chunks.push(chunk)
+    entry.logCount += chunk.logs.length
+    // set again so that the cache counts the new size
+    this.entries.set(key, entry)
+  }
+}
+
+export type LogCacheOptions = {
+  /**
+   * Only blocks at least this far behind the latest block are cached, so that
+   * reorged logs are never served from the cache. Defaults to 64
+   */
+  finalityDepth?: number
+}
+
+const DEFAULT_FINALITY_DEPTH = 64
+const DEFAULT_CONCURRENCY = 4
+
+const compareLogs = (a: Log, b: Log) =>
+  a.blockNumber - b.blockNumber || a.logIndex - b.logIndex
+
+/**
+ * Index of the first log at or after the block number
+ */
+const lowerBound = (logs: Log[], blockNumber: number) => {
+  let low = 0
+  let high = logs.length
+  while (low < high) {
+    const mid = (low + high) >>> 1
+    if (logs[mid].blockNumber < blockNumber) low = mid + 1
+    else high = mid
+  }
+  return low
+}
+
+/**
+ * Merges a range into a sorted list of non overlapping ranges,
+ * joining ranges that overlap or are adjacent
+ */
+export const mergeRanges = (
+  ranges: BlockRange[],
+  range: BlockRange
+): BlockRange[] => {
+  const merged: BlockRange[] = []
+  let current = { ...range }
+  for (const r of ranges) {
+    if (r.toBlock + 1 < current.fromBlock) merged.push(r)
+    else if (current.toBlock + 1 < r.fromBlock) {
+      merged.push(current)
+      current = r
+    } else {
+      current = {
+        fromBlock: Math.min(r.fromBlock, current.fromBlock),
+        toBlock: Math.max(r.toBlock, current.toBlock),
+      }
+    }
+  }
+  merged.push(current)
+  return merged
+}
+
+/**
+ * Sorts ranges and merges those that overlap or are adjacent
+ */
+export const normaliseRanges = (ranges: BlockRange[]): BlockRange[] => {
+  const sorted = [...ranges].sort((a, b) => a.fromBlock - b.fromBlock)
+  const merged: BlockRange[] = []
+  for (const r of sorted) {
+    const last = merged[merged.length - 1]
+    if (last && r.fromBlock <= last.toBlock + 1) {
+      last.toBlock = Math.max(last.toBlock, r.toBlock)
+    } else merged.push({ ...r })
+  }
+  return merged
+}
+
+/**
+ * The parts of a range that are not covered by a sorted list of non overlapping ranges
+ */
+export const findGaps = (
+  ranges: BlockRange[],
+  range: BlockRange
+): BlockRange[] => {
+  const gaps: BlockRange[] = []
+  let next = range.fromBlock
+  for (const r of ranges) {
+    if (r.toBlock < next) continue
+    if (r.fromBlock > range.toBlock) break
+    if (r.fromBlock > next) {
+      gaps.push({ fromBlock: next, toBlock: r.fromBlock - 1 })
+    }
+    next = r.toBlock + 1
+  }
+  if (next <= range.toBlock) {
+    gaps.push({ fromBlock: next, toBlock: range.toBlock })
+  }
+  return gaps
+}
+
+/**
+ * Caches raw logs per (chain, address, topics) filter, along with a record of which
+ * block ranges have been fetched, so that only the missing ranges need to be requested.
+ * Only blocks older than the finality depth are cached.
+ */
+export class LogCache {
+  public readonly finalityDepth: number
+
+  /**
+   * Pending writes per key, writes to the same key are applied in order
+   */
+  private readonly writes = new Map<string, Promise<void>>()
+
+  /**
+   * @param store Defaults to an in memory store
+   * @param options
+   */
+  public constructor(
+    public readonly store: LogCacheStore = new InMemoryLogCacheStore(),
+    options?: LogCacheOptions
+  ) {
+    this.finalityDepth = isDefined(options?.finalityDepth)
+      ? options!.finalityDepth
+      : DEFAULT_FINALITY_DEPTH
+  }
+
+  public static getKey(chainId: number, filter: Filter): string {
+    return JSON.stringify([
+      chainId,
+      (filter.address || '').toLowerCase(),
+      (filter.topics || []).map(t =>
+        Array.isArray(t) ? t.map(i => i.toLowerCase()) : t && t.toLowerCase()
+      ),
+    ])
+  }
+
+  /**
+   * Get the logs in a block range, serving finalized blocks from the cache where
+   * possible and fetching the rest.
+   * @param chainId
+   * @param filter Address and topics filter, block tags are ignored
+   * @param range
+   * @param latestBlock The current head of the chain
+   * @param fetchLogs Fetches the logs for a range that is not in the cache
+   * @param concurrency Max number of missing ranges fetched at once. Defaults to 4
+   * @returns Logs sorted by block number and log index
+   */
+  public async getLogs(
+    chainId: number,
+    filter: Filter,
+    range: BlockRange,
+    latestBlock: number,
+    fetchLogs: (range: BlockRange) => Promise<Log[]>,
+    concurrency = DEFAULT_CONCURRENCY
+  ): Promise<Log[]> {
+    const finalizedBlock = latestBlock - this.finalityDepth
+    const [finalizedLogs, unfinalizedLogs] = await Promise.all([
+      range.fromBlock <= finalizedBlock
+        ? this.getFinalizedLogs(
+            LogCache.getKey(chainId, filter),
+            {
+              fromBlock: range.fromBlock,
+              toBlock: Math.min(range.toBlock, finalizedBlock),
+            },
+            fetchLogs,
+            concurrency
+          )
+        : [],
+      range.toBlock > finalizedBlock
+        ? fetchLogs({
+            fromBlock: Math.max(range.fromBlock, finalizedBlock + 1),
+            toBlock: range.toBlock,
+          })
+        : [],
+    ])
+    return finalizedLogs.concat(unfinalizedLogs.sort(compareLogs))
+  }
+
+  private async getFinalizedLogs(
+    key: string,
+    range: BlockRange,
+    fetchLogs: (range: BlockRange) => Promise<Log[]>,
+    concurrency: number
+  ): Promise<Log[]> {
+    const ranges = normaliseRanges(await this.store.getRanges(key))
+    const gaps = findGaps(ranges, range)
+    const [chunks, fetched] = await Promise.all([
+      ranges.some(r => overlaps(r, range))
+        ? this.store.getChunks(key, range)
+        : [],
+      // a fragmented cache can leave many gaps, so only some are fetched at once
+      mapConcurrently(gaps, concurrency, async gap => ({
+        range: gap,
+        logs: await fetchLogs(gap),
+      })),
+    ])
+    if (fetched.length > 0) {
+      // a failed write only means that the ranges are fetched again next time
+      await this.write(key, fetched).catch(() => undefined)
+    }
+
+    // merge the chunks on read, only keeping the logs in the range. Chunks that
+    // overlap the gaps were added by concurrent requests, and were fetched here too
+    const cached = chunks
+      .filter(c => !gaps.some(g => overlaps(g, c.range)))
+      .map(c =>
+        c.logs.slice(
+          lowerBound(c.logs, range.fromBlock),
+          lowerBound(c.logs, range.toBlock + 1)
+        )
+      )
+    return ([] as Log[])
+      .concat(...cached, ...fetched.map(f => f.logs))
+      .sort(compareLogs)
+  }
+
+  /**
+   * Add fetched ranges to the store as new chunks. The stored ranges are re-read before
+   * writing since other requests for the same key may have been written in the meantime,
+   * and only the parts of the fetched ranges that are still missing are added.
+   */
+  private write(key: string, fetched: LogCacheChunk[]): Promise<void> {
+    const previous = this.writes.get(key) || Promise.resolve()
+    const write = previous.then(async () => {
+      let ranges = normaliseRanges(await this.store.getRanges(key))
+      for (const { range, logs } of fetched) {
+        for (const gap of findGaps(ranges, range)) {
+          await this.store.addChunk(key, {
+            range: gap,
+            logs: logs
+              .filter(
+                l =>
+                  l.blockNumber >= gap.fromBlock && l.blockNumber <= gap.toBlock
+              )
+              .sort(compareLogs),
+          })
+          ranges = mergeRanges(ranges, gap)
+        }
+      }
+    })
+    const settled = write.catch(() => undefined)
+    this.writes.set(key, settled)
+    settled.then(() => {
+      if (this.writes.get(key) === settled) this.writes.delete(key)
+    })
+    return write
+  }
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+/**
+ * A map bounded to a max number of entries, evicting the least recently used
+ * entry when full. Relies on Map preserving insertion order.
+ * Entries can instead be weighed with sizeOf, in which case the total size of the
+ * entries is bounded. An entry that is larger than the bound on its own is not kept.
+ */
+export class LruCache<K, V> {
+  /**
+   * Values along with their size when they were set, as they may since have changed
+   */
+  private readonly entries = new Map<K, { value: V; size: number }>()
+  private totalSize = 0
+
+  /**
+   * @param maxSize Max number of entries to hold, or max total size if sizeOf is provided
+   * @param sizeOf Size of an entry. Values that are changed in place must be set again
+   * for the change in size to be counted
+   */
+  public constructor(
+    public readonly maxSize: number,
+    private readonly sizeOf: (value: V) => number = () => 1
+  ) {}
+
+  public get size(): number {
+    return this.entries.size
+  }
+
+  public has(key: K): boolean {
+    return this.entries.has(key)
+  }
+
+  public get(key: K): V | undefined {
+    const entry = this.entries.get(key)
+    if (!entry) return undefined
+    // move to the most recently used position
+    this.entries.delete(key)
+    this.entries.set(key, entry)
+    return entry.value
+  }
+
+  public set(key: K, value: V): void {
+    this.delete(key)
+    const size = this.sizeOf(value)
+    this.entries.set(key, { value, size })
+    this.totalSize += size
+    while (this.totalSize > this.maxSize) {
+      this.delete(this.entries.keys().next().value as K)
+    }
+  }
+
+  public delete(key: K): boolean {
+    const entry = this.entries.get(key)
+    if (!entry) return false
+    this.entries.delete(key)
+    this.totalSize -= entry.size
+    return true
+  }
+
+  public clear(): void {
+    this.entries.clear()
+    this.totalSize = 0
+  }
+}
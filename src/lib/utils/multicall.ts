@@ -17,12 +17,16 @@
 'use strict'
 
 import { Provider } from '@ethersproject/abstract-provider'
+import { Logger } from '@ethersproject/logger'
 import { BigNumber, utils } from 'ethers'
 
 import { ERC20__factory } from '../abi/factories/ERC20__factory'
 import { Multicall2 } from '../abi/Multicall2'
 import { Multicall2__factory } from '../abi/factories/Multicall2__factory'
+import { decodeTryAggregateResult, encodeTryAggregate } from '../abi/fastCodecs'
 import { ArbSdkError } from '../dataEntities/errors'
+import { SignerProviderUtils } from '../dataEntities/signerOrProvider'
+import { mapConcurrently } from './lib'
 import {
   isL1Network,
   L1Network,
@@ -30,6 +34,7 @@ import {
   L2Network,
   l2Networks,
 } from '../dataEntities/networks'
+import { getInterface } from './contractCache'
 
 /**
  * Input to multicall aggregator
@@ -47,8 +52,41 @@ export type CallInput<T> = {
    * Function to decode the result of the call
    */
   decoder: (returnData: string) => T
+  /**
+   * Optional estimate of the gas used by the call, used when splitting
+   * large multicalls into chunks. Defaults to MultiCallChunkOptions.gasPerCall
+   */
+  gasEstimate?: number
 }
 
+/**
+ * Options for splitting a large multicall into several smaller ones
+ */
+export type MultiCallChunkOptions = {
+  /**
+   * Max estimated size, in bytes, of the abi encoded calls in a single multicall.
+   * Defaults to 100kb
+   */
+  maxCallDataSize?: number
+  /**
+   * Max estimated gas of a single multicall. Defaults to 25m
+   */
+  maxGas?: number
+  /**
+   * Gas estimate for calls that don't provide their own. Defaults to 100k
+   */
+  gasPerCall?: number
+  /**
+   * Max number of multicalls in flight at once. Defaults to 4
+   */
+  parallelism?: number
+}
+
+const DEFAULT_MAX_CALL_DATA_SIZE = 100000
+const DEFAULT_MAX_GAS = 25000000
+const DEFAULT_GAS_PER_CALL = 100000
+const DEFAULT_PARALLELISM = 4
+
 /**
  * For each item in T this DecoderReturnType<T> yields the return
  * type of the decoder property.
@@ -121,16 +159,24 @@ export class MultiCaller {
     /**
      * Address of multicall contract
      */
-    public readonly address: string
+    public readonly address: string,
+    /**
+     * Default options for splitting large multicalls into chunks
+     */
+    public readonly chunkOptions?: MultiCallChunkOptions
   ) {}
 
   /**
    * Finds the correct multicall address for the given provider and instantiates a multicaller
    * @param provider
+   * @param chunkOptions Default options for splitting large multicalls into chunks
    * @returns
    */
-  public static async fromProvider(provider: Provider): Promise<MultiCaller> {
-    const chainId = (await provider.getNetwork()).chainId
+  public static async fromProvider(
+    provider: Provider,
+    chunkOptions?: MultiCallChunkOptions
+  ): Promise<MultiCaller> {
+    const chainId = await SignerProviderUtils.getChainId(provider)
     const l2Network = l2Networks[chainId] as L2Network | undefined
     const l1Network = l1Networks[chainId] as L1Network | undefined
 
@@ -153,7 +199,7 @@ export class MultiCaller {
       multiCallAddr = network.tokenBridge.l2Multicall
     }
 
-    return new MultiCaller(provider, multiCallAddr)
+    return new MultiCaller(provider, multiCallAddr, chunkOptions)
   }
 
   /**
@@ -163,7 +209,7 @@ export class MultiCaller {
   public getBlockNumberInput(): CallInput<
     Awaited<ReturnType<Multicall2['getBlockNumber']>>
   > {
-    const iFace = Multicall2__factory.createInterface()
+    const iFace = getInterface(Multicall2__factory)
     return {
       targetAddr: this.address,
       encoder: () => iFace.encodeFunctionData('getBlockNumber'),
@@ -179,7 +225,7 @@ export class MultiCaller {
   public getCurrentBlockTimestampInput(): CallInput<
     Awaited<ReturnType<Multicall2['getCurrentBlockTimestamp']>>
   > {
-    const iFace = Multicall2__factory.createInterface()
+    const iFace = getInterface(Multicall2__factory)
     return {
       targetAddr: this.address,
       encoder: () => iFace.encodeFunctionData('getCurrentBlockTimestamp'),
@@ -193,6 +239,11 @@ export class MultiCaller {
    * Return values are order the same as the inputs.
    * If a call failed undefined is returned instead of the value.
    *
+   * Large inputs are split into chunks by estimated calldata size and gas, and the chunks
+   * are executed concurrently. Since each chunk uses tryAggregate a reverting call only
+   * affects its own result, however if a whole chunk reverts (eg. because it exceeded the
+   * node's gas cap) it is split in half and each half retried.
+   *
    * To get better type inference when the individual calls are of different types
    * create your inputs as a tuple and pass the tuple in. The return type will be
    * a tuple of the decoded return types. eg.
@@ -222,6 +273,7 @@ export class MultiCaller {
    * @param provider
    * @param params
    * @param requireSuccess Fail the whole call if any internal call fails
+   * @param chunkOptions Overrides the default chunk options of this multicaller
    * @returns
    */
   public async multiCall<
@@ -229,19 +281,26 @@ export class MultiCaller {
     TRequireSuccess extends boolean
   >(
     params: T,
-    requireSuccess?: TRequireSuccess
+    requireSuccess?: TRequireSuccess,
+    chunkOptions?: MultiCallChunkOptions
   ): Promise<DecoderReturnType<T, TRequireSuccess>> {
     const defaultedRequireSuccess = requireSuccess || false
-    const multiCall = Multicall2__factory.connect(this.address, this.provider)
     const args = params.map(p => ({
       target: p.targetAddr,
       callData: p.encoder(),
     }))
 
-    const outputs = await multiCall.callStatic.tryAggregate(
-      defaultedRequireSuccess,
-      args
-    )
+    const options = { ...this.chunkOptions, ...chunkOptions }
+    const chunks = this.chunkCalls(params, args, options)
+    // chunks are contiguous ranges of the inputs, so flattening them
+    // in order gives back outputs ordered the same as the inputs
+    const outputs = (
+      await mapConcurrently(
+        chunks,
+        options.parallelism || DEFAULT_PARALLELISM,
+        chunk => this.tryAggregate(chunk, defaultedRequireSuccess)
+      )
+    ).flat(1)
 
     return outputs.map(({ success, returnData }, index) => {
       if (success && returnData && returnData != '0x') {
@@ -251,6 +310,96 @@ export class MultiCaller {
     }) as DecoderReturnType<T, TRequireSuccess>
   }
 
+  /**
+   * Split the encoded calls into contiguous chunks that fit within the
+   * calldata size and gas limits
+   */
+  private chunkCalls(
+    params: CallInput<unknown>[],
+    args: { target: string; callData: string }[],
+    options: MultiCallChunkOptions
+  ): { target: string; callData: string }[][] {
+    const maxCallDataSize =
+      options.maxCallDataSize || DEFAULT_MAX_CALL_DATA_SIZE
+    const maxGas = options.maxGas || DEFAULT_MAX_GAS
+    const gasPerCall = options.gasPerCall || DEFAULT_GAS_PER_CALL
+
+    const chunks: { target: string; callData: string }[][] = []
+    let current: { target: string; callData: string }[] = []
+    let currentSize = 0
+    let currentGas = 0
+    args.forEach((arg, index) => {
+      // each (address, bytes) tuple in the abi encoded array takes an offset, the address,
+      // the bytes offset and length words, followed by the padded call data
+      const size =
+        4 * 32 + Math.ceil(utils.hexDataLength(arg.callData) / 32) * 32
+      const gas = params[index].gasEstimate || gasPerCall
+      if (
+        current.length > 0 &&
+        (currentSize + size > maxCallDataSize || currentGas + gas > maxGas)
+      ) {
+        chunks.push(current)
+        current = []
+        currentSize = 0
+        currentGas = 0
+      }
+      current.push(arg)
+      currentSize += size
+      currentGas += gas
+    })
+    if (current.length > 0) chunks.push(current)
+
+    return chunks
+  }
+
+  /**
+   * Execute a single tryAggregate. If the aggregate call itself reverts, eg. because it ran
+   * out of gas, it is split in half and each half is retried, so that a chunk exceeding the
+   * node's gas cap is still executed. Any other error, such as a timeout or rate limit, is
+   * rethrown since splitting would only multiply the requests.
+   */
+  private async tryAggregate(
+    args: { target: string; callData: string }[],
+    requireSuccess: boolean
+  ): Promise<{ success: boolean; returnData: string }[]> {
+    // if success is required a revert is an expected failure mode, so we dont retry
+    const canSplit = !requireSuccess && args.length > 1
+
+    let returnData: string
+    try {
+      returnData = await this.provider.call(
+        { to: this.address, data: encodeTryAggregate(requireSuccess, args) },
+        // no block tag, as with callStatic
+        undefined
+      )
+    } catch (err) {
+      const code = (err as { code?: string }).code
+      if (!canSplit || code !== Logger.errors.CALL_EXCEPTION) throw err
+      return await this.splitTryAggregate(args, requireSuccess)
+    }
+
+    try {
+      return decodeTryAggregateResult(returnData)
+    } catch (err) {
+      // providers can return the revert data of a reverted call rather than throwing,
+      // which does not decode as a result
+      if (!canSplit) throw err
+      return await this.splitTryAggregate(args, requireSuccess)
+    }
+  }
+
+  private async splitTryAggregate(
+    args: { target: string; callData: string }[],
+    requireSuccess: boolean
+  ): Promise<{ success: boolean; returnData: string }[]> {
+    const mid = Math.ceil(args.length / 2)
+    const [left, right] = await Promise.all([
+      this.tryAggregate(args.slice(0, mid), requireSuccess),
+      this.tryAggregate(args.slice(mid), requireSuccess),
+    ])
+    return [...left, ...right]
+  }
+
   /**
    * Multicall for token properties. Will collect all the requested properies for each of the
    * supplied token addresses.
@@ -278,7 +427,7 @@ export class MultiCaller {
   > {
     // if no options are supplied, then we just multicall for the names
     const defaultedOptions: TokenMultiInput = options || { name: true }
-    const erc20Iface = ERC20__factory.createInterface()
+    const erc20Iface = getInterface(ERC20__factory)
 
     const isBytes32 = (data: string) =>
       utils.isHexString(data) && utils.hexDataLength(data) === 32
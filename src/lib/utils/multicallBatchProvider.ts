@@ -0,0 +1,229 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import {
+  JsonRpcProvider,
+  JsonRpcFetchFunc,
+  Web3Provider,
+} from '@ethersproject/providers'
+import { Networkish } from '@ethersproject/networks'
+import { Logger } from '@ethersproject/logger'
+
+import { decodeTryAggregateResult, encodeTryAggregate } from '../abi/fastCodecs'
+import { NODE_INTERFACE_ADDRESS } from '../dataEntities/constants'
+import { errorText, isRateLimitError } from '../dataEntities/errors'
+import { MultiCaller } from './multicall'
+
+export type MultiCallBatchOptions = {
+  /**
+   * How long (ms) to collect calls before flushing them as one multicall.
+   * Defaults to 0, which batches the calls issued in the same event loop tick
+   */
+  windowMs?: number
+  /**
+   * Max number of calls in a single multicall, larger batches are split.
+   * Defaults to 100
+   */
+  maxBatchSize?: number
+}
+
+const DEFAULT_MAX_BATCH_SIZE = 100
+
+/**
+ * Whether an eth_call reverted, eg. by running out of gas. send throws the node's
+ * JSON-RPC error rather than a CALL_EXCEPTION, so its code and message are checked too
+ */
+const isCallException = (err: unknown): boolean => {
+  const e = err as { code?: string; error?: { code?: number } }
+  if (e?.code === Logger.errors.CALL_EXCEPTION) return true
+  if (isRateLimitError(err)) return false
+  // eg. geth returns code 3 for reverts with data
+  if (e?.error?.code === 3) return true
+  return [/revert/i, /out of gas/i, /gas required exceeds/i].some(r =>
+    r.test(errorText(err))
+  )
+}
+
+type QueuedCall = {
+  to: string
+  data: string
+  resolve: (returnData: string) => void
+  reject: (err: unknown) => void
+}
+
+/**
+ * A provider that coalesces the read only calls (eg. contract.callStatic) issued within
+ * a short window into a single Multicall2.tryAggregate eth_call.
+ *
+ * Only calls that consist of just a `to` and `data` are batched, anything with a `from`,
+ * value or gas settings is sent as is. Calls are made from the multicall contract, so
+ * this should not be used for view functions that depend on msg.sender.
+ * If a call fails within the aggregate, or the aggregate itself reverts or returns data
+ * that does not decode, the affected calls are resent individually so that callers
+ * receive the same errors they would without batching. Any other failure of the
+ * aggregate, such as a timeout or rate limit, is passed to all of its callers.
+ */
+export class MultiCallBatchProvider extends Web3Provider {
+  /**
+   * Queued calls keyed by block tag
+   */
+  private readonly queues = new Map<string, QueuedCall[]>()
+  private flushScheduled = false
+
+  /**
+   * @param underlying The provider the batched calls will be sent to
+   * @param multicallAddress Address of a Multicall2 contract on the provider's network
+   * @param options
+   * @param network
+   */
+  public constructor(
+    private readonly underlying: JsonRpcProvider,
+    public readonly multicallAddress: string,
+    private readonly options?: MultiCallBatchOptions,
+    network?: Networkish
+  ) {
+    super(underlying.send.bind(underlying) as JsonRpcFetchFunc, network)
+  }
+
+  /**
+   * Finds the correct multicall address for the given provider and instantiates a batch provider
+   * @param provider
+   * @param options
+   * @returns
+   */
+  public static async fromProvider(
+    provider: JsonRpcProvider,
+    options?: MultiCallBatchOptions
+  ): Promise<MultiCallBatchProvider> {
+    const multiCaller = await MultiCaller.fromProvider(provider)
+    return new MultiCallBatchProvider(
+      provider,
+      multiCaller.address,
+      options,
+      await provider.getNetwork()
+    )
+  }
+
+  public override send(method: string, params: Array<any>): Promise<any> {
+    if (method === 'eth_call' && this.isBatchable(params)) {
+      return new Promise<string>((resolve, reject) => {
+        const blockTag = params[1] || 'latest'
+        const queue = this.queues.get(blockTag) || []
+        queue.push({ to: params[0].to, data: params[0].data, resolve, reject })
+        this.queues.set(blockTag, queue)
+        this.scheduleFlush()
+      })
+    }
+    return super.send(method, params)
+  }
+
+  private isBatchable(params: Array<any>): boolean {
+    const tx = params[0]
+    if (!tx || typeof tx.to !== 'string' || typeof tx.data !== 'string')
+      return false
+    // the node interface is only available to top level calls
+    if (tx.to.toLowerCase() === NODE_INTERFACE_ADDRESS.toLowerCase())
+      return false
+    return Object.keys(tx).every(k => k === 'to' || k === 'data')
+  }
+
+  private scheduleFlush() {
+    if (this.flushScheduled) return
+    this.flushScheduled = true
+    setTimeout(() => this.flush(), this.options?.windowMs || 0)
+  }
+
+  private flush() {
+    this.flushScheduled = false
+    const maxBatchSize = this.options?.maxBatchSize || DEFAULT_MAX_BATCH_SIZE
+    const queues = Array.from(this.queues.entries())
+    this.queues.clear()
+
+    for (const [blockTag, calls] of queues) {
+      for (let i = 0; i < calls.length; i += maxBatchSize) {
+        // errors are passed to the individual callers, so this never rejects
+        this.executeBatch(blockTag, calls.slice(i, i + maxBatchSize))
+      }
+    }
+  }
+
+  private async executeBatch(
+    blockTag: string,
+    calls: QueuedCall[]
+  ): Promise<void> {
+    if (calls.length === 1) {
+      await this.sendIndividually(blockTag, calls[0])
+      return
+    }
+
+    let returnData: string
+    try {
+      returnData = await this.underlying.send('eth_call', [
+        {
+          to: this.multicallAddress,
+          data: encodeTryAggregate(
+            false,
+            calls.map(c => ({ target: c.to, callData: c.data }))
+          ),
+        },
+        blockTag,
+      ])
+    } catch (err) {
+      // the aggregate reverted, eg. the batch exceeded the node's gas cap, so fall
+      // back to individual calls. Other errors, such as timeouts or rate limits,
+      // would only be multiplied by resending
+      if (isCallException(err)) await this.sendAllIndividually(blockTag, calls)
+      else calls.forEach(c => c.reject(err))
+      return
+    }
+
+    let results: { success: boolean; returnData: string }[]
+    try {
+      results = decodeTryAggregateResult(returnData)
+    } catch (err) {
+      // eg. the multicall doesnt exist at this block
+      await this.sendAllIndividually(blockTag, calls)
+      return
+    }
+
+    await Promise.all(
+      results.map(async ({ success, returnData }, index) => {
+        if (success) calls[index].resolve(returnData)
+        // resend failures so that the caller receives the original revert error
+        else await this.sendIndividually(blockTag, calls[index])
+      })
+    )
+  }
+
+  private async sendAllIndividually(blockTag: string, calls: QueuedCall[]) {
+    await Promise.all(calls.map(c => this.sendIndividually(blockTag, c)))
+  }
+
+  private async sendIndividually(blockTag: string, call: QueuedCall) {
+    try {
+      call.resolve(
+        await this.underlying.send('eth_call', [
+          { to: call.to, data: call.data },
+          blockTag,
+        ])
+      )
+    } catch (err) {
+      call.reject(err)
+    }
+  }
+}
@@ -0,0 +1,228 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { Provider } from '@ethersproject/abstract-provider'
+import { TransactionReceipt } from '@ethersproject/providers'
+
+import { getTransactionReceipts } from './jsonRpcBatcher'
+
+type ReceiptWaiter = {
+  txHash: string
+  confirmations: number
+  resolve: (receipt: TransactionReceipt | null) => void
+  timer?: ReturnType<typeof setTimeout>
+}
+
+/**
+ * Waits for transaction receipts on behalf of any number of callers with a single block
+ * listener per provider. Each check either fetches the new blocks and only looks up the
+ * receipts of the pending transactions included in them, or, when fewer transactions are
+ * pending than there are new blocks, looks up their receipts directly. Either way the
+ * requests are made in a JSON-RPC batch where the provider supports it, so waiting on many
+ * transactions costs about one request per block rather than one per block per transaction.
+ * Once a receipt is found it is only fetched again when it has enough confirmations, to
+ * check that it was not reorged. The block listener is removed when nobody is waiting.
+ */
+export class TransactionReceiptWaiter {
+  private static readonly waiters = new WeakMap<
+    Provider,
+    TransactionReceiptWaiter
+  >()
+
+  private readonly pending = new Set<ReceiptWaiter>()
+  /**
+   * Receipts that have been found, but do not have enough confirmations yet
+   */
+  private readonly found = new Map<string, TransactionReceipt>()
+  /**
+   * Transactions whose receipts have to be looked up directly, as they may have been
+   * included in a block that was not fetched
+   */
+  private readonly unchecked = new Set<string>()
+  /**
+   * Blocks reported since the last check
+   */
+  private newBlocks: number[] = []
+  private listening = false
+  private checking = false
+  // a block arrived while checking, so check again once done
+  private recheck = false
+
+  public constructor(public readonly provider: Provider) {}
+
+  /**
+   * Get the waiter shared by all users of a provider
+   * @param provider
+   * @returns
+   */
+  public static forProvider(provider: Provider): TransactionReceiptWaiter {
+    let waiter = this.waiters.get(provider)
+    if (!waiter) {
+      waiter = new TransactionReceiptWaiter(provider)
+      this.waiters.set(provider, waiter)
+    }
+    return waiter
+  }
+
+  /**
+   * Wait for a transaction to be mined and have a number of confirmations
+   * @param txHash
+   * @param confirmations Defaults to 1. With 0 the receipt is looked up once without
+   * waiting, as with provider.waitForTransaction
+   * @param timeout Max time (ms) to wait
+   * @returns The receipt, or null if the timeout was reached first
+   */
+  public async waitForReceipt(
+    txHash: string,
+    confirmations = 1,
+    timeout?: number
+  ): Promise<TransactionReceipt | null> {
+    if (confirmations <= 0) {
+      return (await getTransactionReceipts(this.provider, [txHash]))[0]
+    }
+
+    return await new Promise(resolve => {
+      const waiter: ReceiptWaiter = {
+        txHash,
+        confirmations,
+        resolve: (receipt: TransactionReceipt | null) => {
+          if (waiter.timer) clearTimeout(waiter.timer)
+          this.pending.delete(waiter)
+          if (!Array.from(this.pending).some(w => w.txHash === txHash)) {
+            this.found.delete(txHash)
+            this.unchecked.delete(txHash)
+          }
+          this.updateListener()
+          resolve(receipt)
+        },
+      }
+      if (timeout) {
+        waiter.timer = setTimeout(() => waiter.resolve(null), timeout)
+      }
+      this.pending.add(waiter)
+      this.updateListener()
+      // the transaction may already be mined
+      this.unchecked.add(txHash)
+      this.onBlock()
+    })
+  }
+
+  private readonly blockListener = (blockNumber: number) => {
+    this.newBlocks.push(blockNumber)
+    this.onBlock()
+  }
+
+  private updateListener() {
+    if (this.pending.size > 0 && !this.listening) {
+      this.provider.on('block', this.blockListener)
+      this.listening = true
+    } else if (this.pending.size === 0 && this.listening) {
+      this.provider.off('block', this.blockListener)
+      this.listening = false
+      this.newBlocks = []
+    }
+  }
+
+  private async onBlock(): Promise<void> {
+    if (this.checking) {
+      this.recheck = true
+      return
+    }
+    this.checking = true
+    try {
+      do {
+        this.recheck = false
+        await this.checkReceipts()
+      } while (this.recheck && this.pending.size > 0)
+    } finally {
+      this.checking = false
+    }
+  }
+
+  private async checkReceipts(): Promise<void> {
+    const waiters = Array.from(this.pending)
+    const blocks = this.newBlocks
+    this.newBlocks = []
+    if (waiters.length === 0) return
+    const latestBlock = blocks.length > 0 ? Math.max(...blocks) : undefined
+
+    const confirmationsOf = (receipt: TransactionReceipt) =>
+      Math.max(
+        latestBlock === undefined ? 0 : latestBlock - receipt.blockNumber + 1,
+        receipt.confirmations || 0
+      )
+    // found receipts that now have enough confirmations for one of their waiters
+    const due = new Set(
+      waiters
+        .filter(w => {
+          const receipt = this.found.get(w.txHash)
+          return receipt && confirmationsOf(receipt) >= w.confirmations
+        })
+        .map(w => w.txHash)
+    )
+    const notFound = Array.from(
+      new Set(waiters.map(w => w.txHash).filter(h => !this.found.has(h)))
+    )
+
+    let receipts: Map<string, TransactionReceipt | null>
+    try {
+      let toFetch: string[]
+      if (this.unchecked.size > 0 || notFound.length <= blocks.length) {
+        toFetch = notFound
+      } else {
+        // more transactions are pending than there are new blocks, so only look up
+        // the receipts of the transactions in those blocks
+        const included = new Set<string>()
+        for (const block of await Promise.all(
+          blocks.map(n => this.provider.getBlock(n))
+        )) {
+          for (const h of block?.transactions || []) included.add(h)
+        }
+        toFetch = notFound.filter(h => included.has(h))
+      }
+      toFetch.push(...Array.from(due))
+
+      this.unchecked.clear()
+      const fetched = await getTransactionReceipts(this.provider, toFetch)
+      receipts = new Map(toFetch.map((h, i) => [h, fetched[i]]))
+    } catch (err) {
+      // transient errors are retried on the next block, any block
+      // that could not be fetched is covered by a direct lookup
+      for (const h of notFound) this.unchecked.add(h)
+      return
+    }
+
+    for (const [txHash, receipt] of Array.from(receipts)) {
+      if (receipt) this.found.set(txHash, receipt)
+      else if (this.found.delete(txHash)) {
+        // the receipt was reorged out, and the transaction may have been included
+        // again in a block that has already been checked
+        this.unchecked.add(txHash)
+      }
+    }
+    for (const waiter of waiters) {
+      const receipt = receipts.get(waiter.txHash)
+      // only resolve with receipts that were fetched in this check
+      if (!receipt) continue
+      const receiptConfirmations = confirmationsOf(receipt)
+      if (receiptConfirmations >= waiter.confirmations) {
+        waiter.resolve({ ...receipt, confirmations: receiptConfirmations })
+      }
+    }
+  }
+}
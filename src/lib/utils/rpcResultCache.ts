@@ -0,0 +1,132 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { LruCache } from './lruCache'
+
+/**
+ * Storage backend for an RpcResultCache. Values are raw JSON-RPC results,
+ * so they can be serialised as they are
+ */
+export interface RpcResultCacheStore {
+  get(key: string): Promise<any | undefined>
+  set(key: string, value: any): Promise<void>
+}
+
+/**
+ * Holds results in memory, evicting the least recently used
+ */
+export class InMemoryRpcResultCacheStore implements RpcResultCacheStore {
+  private readonly entries: LruCache<string, any>
+
+  /**
+   * @param maxEntries Max number of results to hold. Defaults to 10000
+   */
+  public constructor(maxEntries = 10000) {
+    this.entries = new LruCache(maxEntries)
+  }
+
+  public async get(key: string): Promise<any | undefined> {
+    return this.entries.get(key)
+  }
+
+  public async set(key: string, value: any): Promise<void> {
+    this.entries.set(key, value)
+  }
+}
+
+export type RpcResultCacheOptions = {
+  /**
+   * Only receipts at least this many blocks behind the latest block are cached,
+   * so that reorged receipts are never served from the cache. Defaults to 64
+   */
+  receiptConfirmations?: number
+}
+
+const DEFAULT_RECEIPT_CONFIRMATIONS = 64
+
+/**
+ * Caches the raw results of JSON-RPC requests whose results can no longer change:
+ * blocks by hash, and transaction receipts once they are deep enough to be final.
+ * Raw results are cached, rather than formatted ones, so that formatting, including
+ * any chain specific fields, is unaffected by the cache.
+ */
+export class RpcResultCache {
+  /**
+   * @param store Defaults to an in memory store
+   * @param options
+   */
+  public constructor(
+    private readonly store: RpcResultCacheStore = new InMemoryRpcResultCacheStore(),
+    private readonly options?: RpcResultCacheOptions
+  ) {}
+
+  /**
+   * Whether results of this method can be cached
+   * @param method
+   */
+  public static isCacheable(method: string): boolean {
+    return (
+      method === 'eth_getBlockByHash' || method === 'eth_getTransactionReceipt'
+    )
+  }
+
+  /**
+   * Get the result of a cacheable request from the cache, or send it and cache the result if final
+   * @param chainId Chain the request is for, as stores may be shared between chains
+   * @param method
+   * @param params
+   * @param send Sends the request
+   * @param getBlockNumber Gets the latest block number, used to check if receipts are final
+   * @returns
+   */
+  public async send(
+    chainId: number,
+    method: string,
+    params: Array<any>,
+    send: (method: string, params: Array<any>) => Promise<any>,
+    getBlockNumber: () => Promise<number>
+  ): Promise<any> {
+    // hashes are case insensitive
+    const key = `${chainId}:${method}:${JSON.stringify(params).toLowerCase()}`
+    const cached = await this.store.get(key)
+    if (cached !== undefined) return cached
+
+    const result = await send(method, params)
+    if (result && (await this.isFinal(method, result, getBlockNumber))) {
+      // a failed write only means the result is fetched again later
+      this.store.set(key, result).catch(() => undefined)
+    }
+    return result
+  }
+
+  private async isFinal(
+    method: string,
+    result: any,
+    getBlockNumber: () => Promise<number>
+  ): Promise<boolean> {
+    // the contents of a block are fixed by its hash
+    if (method === 'eth_getBlockByHash') return true
+
+    // receipts of pending transactions have no block number
+    if (result.blockNumber == null) return false
+    const confirmations =
+      this.options?.receiptConfirmations ?? DEFAULT_RECEIPT_CONFIRMATIONS
+    const blockNumber = parseInt(result.blockNumber, 16)
+    return (await getBlockNumber()) - blockNumber >= confirmations
+  }
+}
@@ -0,0 +1,272 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { expect } from 'chai'
+import { createServer, Server } from 'http'
+import { AddressInfo } from 'net'
+import { providers } from 'ethers'
+
+import { ArbitrumProvider } from '../../src/lib/utils/arbProvider'
+import { RpcResultCache } from '../../src/lib/utils/rpcResultCache'
+
+type JsonRpcRequest = { id: number; method: string; params: any[] }
+
+describe('ArbitrumProvider', () => {
+  // an Arbitrum One JSON-RPC endpoint that echoes the first param of other
+  // methods, fails network detection while failNetwork is set, and rejects
+  // batches larger than maxBatchSize
+  let server: Server
+  let url: string
+  let bodies: (JsonRpcRequest | JsonRpcRequest[])[]
+  let maxBatchSize: number
+  let failNetwork: boolean
+
+  const respond = (req: JsonRpcRequest) => {
+    if (req.method !== 'eth_chainId' && req.method !== 'net_version') {
+      return { jsonrpc: '2.0', id: req.id, result: req.params[0] }
+    }
+    return failNetwork
+      ? {
+          jsonrpc: '2.0',
+          id: req.id,
+          error: { code: -32000, message: 'unavailable' },
+        }
+      : { jsonrpc: '2.0', id: req.id, result: '0xa4b1' }
+  }
+
+  before(async () => {
+    server = createServer((req, res) => {
+      let body = ''
+      req.on('data', chunk => (body += chunk))
+      req.on('end', () => {
+        const payload = JSON.parse(body)
+        bodies.push(payload)
+        if (Array.isArray(payload) && payload.length > maxBatchSize) {
+          res.writeHead(413)
+          res.end()
+          return
+        }
+        res.writeHead(200, { 'Content-Type': 'application/json' })
+        res.end(
+          JSON.stringify(
+            Array.isArray(payload) ? payload.map(respond) : respond(payload)
+          )
+        )
+      })
+    })
+    await new Promise<void>(resolve => server.listen(0, '127.0.0.1', resolve))
+    url = `http://127.0.0.1:${(server.address() as AddressInfo).port}`
+  })
+
+  after(() => server.close())
+
+  beforeEach(() => {
+    bodies = []
+    maxBatchSize = Infinity
+    failNetwork = false
+  })
+
+  const createProvider = () =>
+    new providers.StaticJsonRpcProvider(url, {
+      chainId: 42161,
+      name: 'arbitrum',
+    })
+
+  // requests of a method, whether sent individually or in a batch
+  const requestsOf = (method: string) =>
+    ([] as JsonRpcRequest[])
+      .concat(...bodies)
+      .filter(r => r.method === method)
+
+  const batchSizes = () =>
+    bodies
+      .filter(b => Array.isArray(b))
+      .map(b => (b as JsonRpcRequest[]).length)
+
+  const call = (i: number) => ({
+    to: '0x000000000000000000000000000000000000006E',
+    data: `0x${i.toString(16).padStart(2, '0')}`,
+  })
+
+  it('sends block, receipt, call and log requests in batches', async () => {
+    const arbProvider = new ArbitrumProvider(createProvider())
+    const hash = `0x${'11'.repeat(32)}`
+
+    const results = await Promise.all([
+      arbProvider.send('eth_getBlockByHash', [hash, false]),
+      arbProvider.send('eth_getTransactionReceipt', [hash]),
+      arbProvider.send('eth_call', [call(1), 'latest']),
+      arbProvider.send('eth_getLogs', [{ fromBlock: '0x1' }]),
+      arbProvider.send('eth_blockNumber', ['0x5']),
+    ])
+
+    expect(results).to.deep.eq([
+      hash,
+      hash,
+      call(1),
+      { fromBlock: '0x1' },
+      '0x5',
+    ])
+    const batches = bodies.filter(b => Array.isArray(b)) as JsonRpcRequest[][]
+    expect(batches.length).to.eq(1)
+    expect(batches[0].map(r => r.method)).to.deep.eq([
+      'eth_getBlockByHash',
+      'eth_getTransactionReceipt',
+      'eth_call',
+      'eth_getLogs',
+    ])
+    // other methods are sent individually
+    expect(
+      bodies.some(b => !Array.isArray(b) && b.method === 'eth_blockNumber')
+    ).to.be.true
+  })
+
+  it('splits rejected batches of more than 10 requests', async () => {
+    const arbProvider = new ArbitrumProvider(createProvider())
+    maxBatchSize = 10
+
+    const results = await Promise.all(
+      Array.from({ length: 24 }, (_, i) =>
+        arbProvider.send('eth_call', [call(i), 'latest'])
+      )
+    )
+
+    expect(results).to.deep.eq(Array.from({ length: 24 }, (_, i) => call(i)))
+    // 24 is rejected, then both 12s, then the 6s are accepted
+    expect(batchSizes().sort((a, b) => b - a)).to.deep.eq([
+      24, 12, 12, 6, 6, 6, 6,
+    ])
+    expect(requestsOf('eth_call').length).to.eq(24 + 24 + 24)
+  })
+
+  it('sends the requests of rejected batches of up to 10 individually', async () => {
+    const arbProvider = new ArbitrumProvider(createProvider())
+    maxBatchSize = 5
+
+    const results = await Promise.all(
+      Array.from({ length: 8 }, (_, i) =>
+        arbProvider.send('eth_call', [call(i), 'latest'])
+      )
+    )
+
+    expect(results).to.deep.eq(Array.from({ length: 8 }, (_, i) => call(i)))
+    expect(batchSizes()).to.deep.eq([8])
+    expect(requestsOf('eth_call').length).to.eq(8 + 8)
+  })
+
+  it('sends through the send of providers that override it', async () => {
+    const sent: string[] = []
+    class AuthProvider extends providers.StaticJsonRpcProvider {
+      override send(method: string, params: Array<any>): Promise<any> {
+        sent.push(method)
+        return super.send(method, params)
+      }
+    }
+    const arbProvider = new ArbitrumProvider(
+      new AuthProvider(url, { chainId: 42161, name: 'arbitrum' })
+    )
+
+    const results = await Promise.all([
+      arbProvider.send('eth_call', [call(1), 'latest']),
+      arbProvider.send('eth_call', [call(2), 'latest']),
+    ])
+
+    expect(results).to.deep.eq([call(1), call(2)])
+    expect(sent).to.deep.eq(['eth_call', 'eth_call'])
+    expect(batchSizes()).to.deep.eq([])
+  })
+
+  it('shares identical requests in flight', async () => {
+    const arbProvider = new ArbitrumProvider(createProvider())
+
+    const results = await Promise.all([
+      arbProvider.send('eth_call', [call(1), 'latest']),
+      arbProvider.send('eth_call', [call(1), 'latest']),
+      arbProvider.send('eth_call', [call(2), 'latest']),
+    ])
+
+    expect(results).to.deep.eq([call(1), call(1), call(2)])
+    expect(requestsOf('eth_call').map(r => r.params[0])).to.deep.eq([
+      call(1),
+      call(2),
+    ])
+
+    // finished requests are not reused
+    await arbProvider.send('eth_call', [call(1), 'latest'])
+    expect(requestsOf('eth_call').length).to.eq(3)
+  })
+
+  it('only detects the network once', async () => {
+    const arbProvider = new ArbitrumProvider(createProvider())
+
+    const networks = await Promise.all([
+      arbProvider.detectNetwork(),
+      arbProvider.detectNetwork(),
+      arbProvider.getNetwork(),
+    ])
+    await arbProvider.detectNetwork()
+
+    expect(networks.map(n => n.chainId)).to.deep.eq([42161, 42161, 42161])
+    expect(requestsOf('eth_chainId').length).to.eq(1)
+  })
+
+  it('detects the network again after a failure', async () => {
+    const arbProvider = new ArbitrumProvider(createProvider())
+    failNetwork = true
+
+    let error: Error | undefined
+    await arbProvider.detectNetwork().catch(err => (error = err))
+    expect(error).to.not.be.undefined
+
+    failNetwork = false
+    const chainIdRequests = requestsOf('eth_chainId').length
+    expect((await arbProvider.detectNetwork()).chainId).to.eq(42161)
+    expect(requestsOf('eth_chainId').length).to.eq(chainIdRequests + 1)
+  })
+
+  it('shares one instance per provider', () => {
+    const provider = createProvider()
+    const arbProvider = ArbitrumProvider.fromProvider(provider)
+
+    expect(ArbitrumProvider.fromProvider(provider)).to.eq(arbProvider)
+    expect(ArbitrumProvider.fromProvider(arbProvider)).to.eq(arbProvider)
+    expect(ArbitrumProvider.fromProvider(createProvider())).to.not.eq(
+      arbProvider
+    )
+  })
+
+  it('fixes the cache of shared instances when they are created', () => {
+    const provider = createProvider()
+    const cache = new RpcResultCache()
+
+    const arbProvider = ArbitrumProvider.fromProvider(provider, cache)
+    expect(arbProvider.cache).to.eq(cache)
+    expect(ArbitrumProvider.fromProvider(provider)).to.eq(arbProvider)
+    expect(ArbitrumProvider.fromProvider(provider, cache)).to.eq(arbProvider)
+    expect(() =>
+      ArbitrumProvider.fromProvider(provider, new RpcResultCache())
+    ).to.throw('already has a different cache')
+
+    // a cache can not be added to an instance created without one
+    const uncached = createProvider()
+    ArbitrumProvider.fromProvider(uncached)
+    expect(() =>
+      ArbitrumProvider.fromProvider(uncached, new RpcResultCache())
+    ).to.throw('already has a different cache')
+  })
+})
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { expect } from 'chai'
+import { BigNumber } from 'ethers'
+import { Provider } from '@ethersproject/abstract-provider'
+import { Logger } from '@ethersproject/logger'
+
+import { ConfirmedNodeWatcher } from '../../src/lib/message/ConfirmedNodeWatcher'
+import { RollupNodeCache } from '../../src/lib/message/RollupNodeCache'
+import { RollupUserLogic } from '../../src/lib/abi/RollupUserLogic'
+
+describe('ConfirmedNodeWatcher', () => {
+  const rollupAddress = '0x5eF0D09d1E6204141B4d37530808eD19f60FBa35'
+
+  // each node confirms 10 more messages. latestConfirmed() answers from the
+  // results, which are node numbers or errors to throw, repeating the last one
+  const createWatcher = (results: (number | Error)[]) => {
+    let polls = 0
+    const rollup = {
+      address: rollupAddress,
+      provider: {} as Provider,
+      callStatic: {
+        latestConfirmed: async () => {
+          const result = results[Math.min(polls++, results.length - 1)]
+          if (result instanceof Error) throw result
+          return BigNumber.from(result)
+        },
+      },
+    } as unknown as RollupUserLogic
+    const nodeCache = {
+      getNode: async (_: RollupUserLogic, nodeNum: BigNumber) => ({
+        sendCount: nodeNum.mul(10),
+      }),
+    } as unknown as RollupNodeCache
+    const watcher = new ConfirmedNodeWatcher(rollup, {} as Provider, nodeCache)
+    return { watcher, polls: () => polls }
+  }
+
+  const callException = () =>
+    Object.assign(new Error('call revert exception'), {
+      code: Logger.errors.CALL_EXCEPTION,
+    })
+
+  it('shares polls between waiters', async () => {
+    const { watcher, polls } = createWatcher([1, 2, 3])
+
+    await Promise.all([
+      watcher.waitForPosition(BigNumber.from(5), 5),
+      watcher.waitForPosition(BigNumber.from(25), 5),
+      watcher.waitForPosition(BigNumber.from(15), 5),
+    ])
+
+    expect(polls()).to.eq(3)
+    // covered positions resolve without polling
+    await watcher.waitForPosition(BigNumber.from(29), 5)
+    expect(polls()).to.eq(3)
+  })
+
+  it('retries polls that fail with transient errors', async () => {
+    const { watcher, polls } = createWatcher([
+      new Error('socket hang up'),
+      new Error('429 Too Many Requests'),
+      1,
+    ])
+
+    await watcher.waitForPosition(BigNumber.from(5), 5)
+
+    expect(polls()).to.eq(3)
+  })
+
+  it('rejects waiters on terminal errors', async () => {
+    const { watcher } = createWatcher([1, callException()])
+
+    let err: Error | undefined
+    try {
+      await watcher.waitForPosition(BigNumber.from(15), 5)
+    } catch (e) {
+      err = e as Error
+    }
+
+    expect(err?.message).to.eq('call revert exception')
+  })
+
+  it('only rejects aborted waiters', async () => {
+    const { watcher } = createWatcher([0, 0, 0, 2])
+    const controller = new AbortController()
+
+    const aborted = watcher.waitForPosition(
+      BigNumber.from(5),
+      5,
+      controller.signal
+    )
+    const waiting = watcher.waitForPosition(BigNumber.from(15), 5)
+    controller.abort()
+
+    let err: Error | undefined
+    try {
+      await aborted
+    } catch (e) {
+      err = e as Error
+    }
+    expect(err?.message).to.eq('Wait aborted.')
+    await waiting
+  })
+
+  it('shares watchers per rollup and providers', () => {
+    const l1Provider = {} as Provider
+    const rollup = {
+      address: rollupAddress,
+      provider: l1Provider,
+    } as unknown as RollupUserLogic
+    const sameRollup = {
+      address: rollupAddress.toLowerCase(),
+      provider: l1Provider,
+    } as unknown as RollupUserLogic
+    const l2Provider = {} as Provider
+    const otherL2Provider = {} as Provider
+
+    const watcher = ConfirmedNodeWatcher.forRollup(rollup, l2Provider)
+
+    expect(ConfirmedNodeWatcher.forRollup(sameRollup, l2Provider)).to.eq(
+      watcher
+    )
+    expect(
+      ConfirmedNodeWatcher.forRollup(rollup, otherL2Provider)
+    ).to.not.eq(watcher)
+  })
+})
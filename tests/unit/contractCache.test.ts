@@ -0,0 +1,86 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { expect } from 'chai'
+import { providers } from 'ethers'
+import { hexZeroPad } from '@ethersproject/bytes'
+
+import {
+  connectContract,
+  createContract,
+  getInterface,
+} from '../../src/lib/utils/contractCache'
+import { ERC20__factory } from '../../src/lib/abi/factories/ERC20__factory'
+import { Inbox__factory } from '../../src/lib/abi/factories/Inbox__factory'
+
+describe('Contract cache', () => {
+  const address = '0x9f8F72aA9304c8B593d555f12eF6589cC3A579A2'
+  const createProvider = () =>
+    new providers.StaticJsonRpcProvider('http://localhost:8545', {
+      chainId: 1,
+      name: 'test',
+    })
+
+  it('parses the interface of a factory once', () => {
+    const iFace = getInterface(ERC20__factory)
+
+    expect(getInterface(ERC20__factory)).to.eq(iFace)
+    expect(getInterface(Inbox__factory)).to.not.eq(iFace)
+  })
+
+  it('pools contracts by factory, address and provider', () => {
+    const provider = createProvider()
+    const contract = connectContract(ERC20__factory, address, provider)
+
+    expect(contract.interface).to.eq(getInterface(ERC20__factory))
+    expect(connectContract(ERC20__factory, address, provider)).to.eq(contract)
+    expect(
+      connectContract(ERC20__factory, address.toLowerCase(), provider)
+    ).to.eq(contract)
+    expect(connectContract(Inbox__factory, address, provider)).to.not.eq(
+      contract
+    )
+    expect(
+      connectContract(ERC20__factory, address, createProvider())
+    ).to.not.eq(contract)
+  })
+
+  it('bounds the number of pooled contracts per provider', () => {
+    const provider = createProvider()
+    const first = connectContract(ERC20__factory, address, provider)
+
+    // spread across factories, which share the bound
+    for (let i = 1; i <= 1000; i++) {
+      const factory = i % 2 === 0 ? ERC20__factory : Inbox__factory
+      connectContract(factory, hexZeroPad('0x' + i.toString(16), 20), provider)
+    }
+
+    expect(connectContract(ERC20__factory, address, provider)).to.not.eq(first)
+  })
+
+  it('creates new contracts for users', () => {
+    const provider = createProvider()
+    const pooled = connectContract(ERC20__factory, address, provider)
+    const created = createContract(ERC20__factory, address, provider)
+
+    expect(created).to.not.eq(pooled)
+    expect(createContract(ERC20__factory, address, provider)).to.not.eq(created)
+    expect(created.interface).to.eq(getInterface(ERC20__factory))
+    expect(created.address).to.eq(address)
+  })
+})
@@ -0,0 +1,320 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { expect } from 'chai'
+import { constants, providers } from 'ethers'
+import { Filter, Log } from '@ethersproject/abstract-provider'
+import { anything, instance, mock, verify, when } from 'ts-mockito'
+
+import { EventFetcher } from '../../src'
+import { LogCache } from '../../src/lib/utils/logCache'
+import { ArbSys__factory } from '../../src/lib/abi/factories/ArbSys__factory'
+import { ARB_SYS_ADDRESS } from '../../src/lib/dataEntities/constants'
+
+describe('EventFetcher', () => {
+  const arbSysIface = ArbSys__factory.createInterface()
+  const destination = '0x0000000000000000000000000000000000000001'
+
+  // one log every 10 blocks, the position encodes the block number and log index
+  const createLog = (blockNumber: number, logIndex: number): Log => {
+    const { data, topics } = arbSysIface.encodeEventLog(
+      arbSysIface.getEvent('L2ToL1Tx'),
+      [
+        constants.AddressZero,
+        destination,
+        1,
+        blockNumber * 10 + logIndex,
+        blockNumber,
+        0,
+        0,
+        0,
+        '0x',
+      ]
+    )
+    return {
+      blockNumber,
+      logIndex,
+      data,
+      topics,
+      address: ARB_SYS_ADDRESS,
+      removed: false,
+      blockHash: constants.HashZero,
+      transactionHash: constants.HashZero,
+      transactionIndex: 0,
+    }
+  }
+
+  const createProviderMock = (maxRange: number, blockCount: number) => {
+    const allLogs: Log[] = []
+    for (let i = 0; i < blockCount; i += 10) {
+      allLogs.push(createLog(i, 0), createLog(i, 1))
+    }
+
+    const requestedRanges: { from: number; to: number }[] = []
+    const providerMock = mock(providers.JsonRpcProvider)
+    when(providerMock._isProvider).thenReturn(true)
+    when(providerMock.getLogs(anything())).thenCall(async (f: Filter) => {
+      const from = f.fromBlock as number
+      const to = f.toBlock as number
+      if (to - from + 1 > maxRange)
+        throw new Error('query returned more than 10000 results')
+      requestedRanges.push({ from, to })
+      // return in reverse order to check that results are sorted
+      return allLogs
+        .filter(l => l.blockNumber >= from && l.blockNumber <= to)
+        .reverse()
+    })
+
+    return {
+      provider: instance(providerMock),
+      providerMock,
+      requestedRanges,
+      allLogs,
+    }
+  }
+
+  const expectCoverage = (
+    ranges: { from: number; to: number }[],
+    from: number,
+    to: number
+  ) => {
+    const sorted = [...ranges].sort((a, b) => a.from - b.from)
+    expect(sorted[0].from, 'first range').to.eq(from)
+    expect(sorted[sorted.length - 1].to, 'last range').to.eq(to)
+    for (let i = 1; i < sorted.length; i++) {
+      expect(sorted[i].from, 'contiguous ranges').to.eq(sorted[i - 1].to + 1)
+    }
+  }
+
+  it('bisects ranges rejected for returning too many results', async () => {
+    const { provider, requestedRanges, allLogs } = createProviderMock(
+      100,
+      1000
+    )
+    const fetcher = new EventFetcher(provider)
+
+    const events = await fetcher.getEvents(
+      ArbSys__factory,
+      t => t.filters.L2ToL1Tx(),
+      { fromBlock: 0, toBlock: 999, address: ARB_SYS_ADDRESS }
+    )
+
+    expect(events.length).to.eq(allLogs.length)
+    const positions = events.map(e => e.event.position.toNumber())
+    expect(positions).to.deep.eq(
+      allLogs.map(l => l.blockNumber * 10 + l.logIndex)
+    )
+    expectCoverage(requestedRanges, 0, 999)
+  })
+
+  it('pages concurrently from a fixed page size', async () => {
+    const { provider, requestedRanges, allLogs } = createProviderMock(
+      200,
+      2000
+    )
+    const fetcher = new EventFetcher(provider, {
+      pageSize: 50,
+      concurrency: 3,
+    })
+
+    const events = await fetcher.getEvents(
+      ArbSys__factory,
+      t => t.filters.L2ToL1Tx(),
+      { fromBlock: 0, toBlock: 1999, address: ARB_SYS_ADDRESS }
+    )
+
+    expect(events.length).to.eq(allLogs.length)
+    const blockNumbers = events.map(e => e.blockNumber)
+    expect(blockNumbers).to.deep.eq([...blockNumbers].sort((a, b) => a - b))
+    expectCoverage(requestedRanges, 0, 1999)
+    // sparse pages should have grown the page size
+    expect(requestedRanges.some(r => r.to - r.from + 1 > 50)).to.be.true
+  })
+
+  it('streams pages that can be resumed from a cursor', async () => {
+    const { provider, allLogs } = createProviderMock(1000, 1000)
+    const fetcher = new EventFetcher(provider)
+    const filter = { fromBlock: 0, toBlock: 999, address: ARB_SYS_ADDRESS }
+
+    const firstPages = []
+    for await (const page of fetcher.streamEvents(
+      ArbSys__factory,
+      t => t.filters.L2ToL1Tx(),
+      filter,
+      { pageSize: 100, concurrency: 2 }
+    )) {
+      firstPages.push(page)
+      if (firstPages.length === 3) break
+    }
+    expect(firstPages.map(p => p.events.length)).to.deep.eq([20, 20, 20])
+
+    // resume from the middle of a block
+    const lastEvent = firstPages[2].events[18]
+    const resumed = []
+    for await (const page of fetcher.streamEvents(
+      ArbSys__factory,
+      t => t.filters.L2ToL1Tx(),
+      filter,
+      {
+        pageSize: 100,
+        cursor: {
+          blockNumber: lastEvent.blockNumber,
+          logIndex: lastEvent.logIndex,
+        },
+      }
+    )) {
+      resumed.push(...page.events)
+    }
+
+    const positions = [
+      ...firstPages.flatMap(p => p.events).slice(0, 59),
+      ...resumed,
+    ].map(e => e.event.position.toNumber())
+    expect(positions).to.deep.eq(
+      allLogs.map(l => l.blockNumber * 10 + l.logIndex)
+    )
+  })
+
+  it('only fetches uncached and unfinalized ranges when using a cache', async () => {
+    const { provider, providerMock, requestedRanges, allLogs } =
+      createProviderMock(1000, 1000)
+    when(providerMock.getNetwork()).thenResolve({ chainId: 1, name: 'test' })
+    when(providerMock.getBlockNumber()).thenResolve(999)
+    const fetcher = new EventFetcher(provider, {
+      cache: new LogCache(undefined, { finalityDepth: 100 }),
+    })
+    const getEvents = (fromBlock: number) =>
+      fetcher.getEvents(ArbSys__factory, t => t.filters.L2ToL1Tx(), {
+        fromBlock,
+        toBlock: 999,
+        address: ARB_SYS_ADDRESS,
+      })
+
+    await getEvents(500)
+    requestedRanges.length = 0
+    const events = await getEvents(0)
+
+    expect(requestedRanges.sort((a, b) => a.from - b.from)).to.deep.eq([
+      { from: 0, to: 499 },
+      { from: 900, to: 999 },
+    ])
+    const positions = events.map(e => e.event.position.toNumber())
+    expect(positions).to.deep.eq(
+      allLogs.map(l => l.blockNumber * 10 + l.logIndex)
+    )
+  })
+
+  it('decodes event args on first access', async () => {
+    const providerMock = mock(providers.JsonRpcProvider)
+    when(providerMock._isProvider).thenReturn(true)
+    when(providerMock.getLogs(anything())).thenResolve([
+      createLog(5, 0),
+      { ...createLog(6, 0), data: '0x' },
+    ])
+    const fetcher = new EventFetcher(instance(providerMock))
+
+    const [valid, invalid] = await fetcher.getEvents(
+      ArbSys__factory,
+      t => t.filters.L2ToL1Tx(),
+      { fromBlock: 0, toBlock: 10, address: ARB_SYS_ADDRESS }
+    )
+
+    expect(invalid.name).to.eq('L2ToL1Tx')
+    expect(invalid.blockNumber).to.eq(6)
+    expect(() => invalid.event).to.throw()
+    expect(valid.event.position.toNumber()).to.eq(50)
+    expect({ ...valid }.event).to.eq(valid.event)
+  })
+
+  it('retries transient errors', async () => {
+    const providerMock = mock(providers.JsonRpcProvider)
+    when(providerMock._isProvider).thenReturn(true)
+    when(providerMock.getLogs(anything()))
+      .thenReject(new Error('socket hang up'))
+      .thenResolve([createLog(5, 0)])
+    const fetcher = new EventFetcher(instance(providerMock))
+
+    const events = await fetcher.getEvents(
+      ArbSys__factory,
+      t => t.filters.L2ToL1Tx(),
+      { fromBlock: 0, toBlock: 10, address: ARB_SYS_ADDRESS },
+      { retries: 1 }
+    )
+
+    expect(events.length).to.eq(1)
+  })
+
+  it('backs off rather than bisecting on rate limits', async () => {
+    const rateLimited = Object.assign(new Error('429 Too Many Requests'), {
+      status: 429,
+    })
+    const requestedRanges: { from: number; to: number }[] = []
+    const providerMock = mock(providers.JsonRpcProvider)
+    when(providerMock._isProvider).thenReturn(true)
+    let calls = 0
+    when(providerMock.getLogs(anything())).thenCall(async (f: Filter) => {
+      requestedRanges.push({
+        from: f.fromBlock as number,
+        to: f.toBlock as number,
+      })
+      if (calls++ < 2) throw rateLimited
+      return [createLog(5, 0)]
+    })
+    const fetcher = new EventFetcher(instance(providerMock))
+
+    const events = await fetcher.getEvents(
+      ArbSys__factory,
+      t => t.filters.L2ToL1Tx(),
+      { fromBlock: 0, toBlock: 999, address: ARB_SYS_ADDRESS },
+      { retries: 2 }
+    )
+
+    expect(events.length).to.eq(1)
+    expect(requestedRanges).to.deep.eq([
+      { from: 0, to: 999 },
+      { from: 0, to: 999 },
+      { from: 0, to: 999 },
+    ])
+  })
+
+  it('does not bisect rate limits that mention a limit', async () => {
+    const providerMock = mock(providers.JsonRpcProvider)
+    when(providerMock._isProvider).thenReturn(true)
+    when(providerMock.getLogs(anything())).thenReject(
+      new Error('daily request count exceeded, request rate limited')
+    )
+    const fetcher = new EventFetcher(instance(providerMock))
+
+    let err: Error | undefined
+    try {
+      await fetcher.getEvents(
+        ArbSys__factory,
+        t => t.filters.L2ToL1Tx(),
+        { fromBlock: 0, toBlock: 999, address: ARB_SYS_ADDRESS },
+        { retries: 0 }
+      )
+    } catch (e) {
+      err = e as Error
+    }
+
+    expect(err?.message).to.eq(
+      'daily request count exceeded, request rate limited'
+    )
+    verify(providerMock.getLogs(anything())).once()
+  })
+})
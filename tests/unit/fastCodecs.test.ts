@@ -0,0 +1,247 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { expect } from 'chai'
+import { BigNumber, constants } from 'ethers'
+import { Interface, Result } from 'ethers/lib/utils'
+
+import {
+  decodeInboxMessageDeliveredEvent,
+  decodeL2ToL1TxEvent,
+  decodeMessageDeliveredEvent,
+  decodeRedeemScheduledEvent,
+  decodeTryAggregateResult,
+  encodeL1OutboundTransfer,
+  encodeL2OutboundTransfer,
+  encodeTryAggregate,
+} from '../../src/lib/abi/fastCodecs'
+import { ArbRetryableTx__factory } from '../../src/lib/abi/factories/ArbRetryableTx__factory'
+import { ArbSys__factory } from '../../src/lib/abi/factories/ArbSys__factory'
+import { Bridge__factory } from '../../src/lib/abi/factories/Bridge__factory'
+import { Inbox__factory } from '../../src/lib/abi/factories/Inbox__factory'
+import { L1GatewayRouter__factory } from '../../src/lib/abi/factories/L1GatewayRouter__factory'
+import { L2GatewayRouter__factory } from '../../src/lib/abi/factories/L2GatewayRouter__factory'
+import { Multicall2__factory } from '../../src/lib/abi/factories/Multicall2__factory'
+
+const address1 = '0x9f8F72aA9304c8B593d555f12eF6589cC3A579A2'
+const address2 = '0x1f9840a85d5aF5bf1D1762F925BDADdC4201F984'
+const hash1 = '0x' + '1a'.repeat(32)
+const hash2 = '0x' + 'b2'.repeat(32)
+// lengths either side of a word boundary
+const bytesOfLength = (length: number) => '0x' + 'c3'.repeat(length)
+
+// ethers decodes large integers to BigNumbers, the codecs to bigints
+const normalise = (value: unknown): unknown =>
+  BigNumber.isBigNumber(value) ? BigInt(value.toString()) : value
+
+const expectArgs = (actual: object, expected: Result) => {
+  for (const [key, value] of Object.entries(actual)) {
+    expect(value, key).to.deep.eq(normalise(expected[key]))
+  }
+}
+
+const encodeLog = (iFace: Interface, event: string, values: unknown[]) =>
+  iFace.encodeEventLog(iFace.getEvent(event), values)
+
+describe('Fast codecs', () => {
+  describe('tryAggregate', () => {
+    const iFace = Multicall2__factory.createInterface()
+    const callSets = [
+      [],
+      [{ target: address1, callData: '0x' }],
+      [
+        { target: address1, callData: '0x06fdde03' },
+        { target: address2, callData: bytesOfLength(32) },
+        { target: address1, callData: bytesOfLength(33) },
+      ],
+    ]
+
+    it('encodes calldata as ethers does', () => {
+      for (const calls of callSets) {
+        for (const requireSuccess of [true, false]) {
+          expect(encodeTryAggregate(requireSuccess, calls)).to.eq(
+            iFace.encodeFunctionData('tryAggregate', [requireSuccess, calls])
+          )
+        }
+      }
+    })
+
+    it('decodes results as ethers does', () => {
+      const resultSets = [
+        [],
+        [{ success: false, returnData: '0x' }],
+        [
+          { success: true, returnData: bytesOfLength(31) },
+          { success: false, returnData: bytesOfLength(64) },
+          { success: true, returnData: hash1 },
+        ],
+      ]
+      for (const results of resultSets) {
+        const returnData = iFace.encodeFunctionResult('tryAggregate', [
+          results,
+        ])
+        const expected = iFace.decodeFunctionResult('tryAggregate', returnData)
+        expect(decodeTryAggregateResult(returnData)).to.deep.eq(
+          expected[0].map((r: Result) => ({
+            success: r.success,
+            returnData: r.returnData,
+          }))
+        )
+      }
+    })
+
+    it('throws on truncated results', () => {
+      const returnData = iFace.encodeFunctionResult('tryAggregate', [
+        [{ success: true, returnData: bytesOfLength(40) }],
+      ])
+      expect(() => decodeTryAggregateResult('0x')).to.throw()
+      expect(() =>
+        decodeTryAggregateResult(returnData.slice(0, -64))
+      ).to.throw()
+    })
+  })
+
+  describe('outboundTransfer', () => {
+    it('encodes l1 calldata as ethers does', () => {
+      const iFace = L1GatewayRouter__factory.createInterface()
+      const amount = BigNumber.from('123456789012345678901234567890')
+      const data = bytesOfLength(65)
+      expect(
+        encodeL1OutboundTransfer(
+          address1,
+          address2,
+          amount,
+          BigInt(300000),
+          10,
+          data
+        )
+      ).to.eq(
+        iFace.encodeFunctionData('outboundTransfer', [
+          address1,
+          address2,
+          amount,
+          300000,
+          10,
+          data,
+        ])
+      )
+    })
+
+    it('encodes l2 calldata as ethers does', () => {
+      const iFace = L2GatewayRouter__factory.createInterface()
+      const amount = constants.MaxUint256
+      expect(encodeL2OutboundTransfer(address1, address2, amount, '0x')).to.eq(
+        iFace.encodeFunctionData(
+          'outboundTransfer(address,address,uint256,bytes)',
+          [address1, address2, amount, '0x']
+        )
+      )
+    })
+
+    it('throws on invalid values', () => {
+      expect(() =>
+        encodeL2OutboundTransfer(address1, address2, -1, '0x')
+      ).to.throw()
+      expect(() =>
+        encodeL2OutboundTransfer(
+          address1,
+          address2,
+          constants.MaxUint256.add(1),
+          '0x'
+        )
+      ).to.throw()
+      expect(() =>
+        encodeL2OutboundTransfer('0x1234', address2, 1, '0x')
+      ).to.throw()
+      expect(() =>
+        encodeL2OutboundTransfer(address1, address2, 1, '0x123')
+      ).to.throw()
+    })
+  })
+
+  describe('events', () => {
+    it('decodes L2ToL1Tx as ethers does', () => {
+      const iFace = ArbSys__factory.createInterface()
+      const log = encodeLog(iFace, 'L2ToL1Tx', [
+        address1,
+        address2,
+        BigNumber.from(hash1),
+        BigNumber.from(15),
+        BigNumber.from(1000000),
+        BigNumber.from(16000000),
+        BigNumber.from(1660000000),
+        constants.MaxUint256,
+        bytesOfLength(100),
+      ])
+      expectArgs(decodeL2ToL1TxEvent(log), iFace.parseLog(log).args)
+    })
+
+    it('decodes MessageDelivered as ethers does', () => {
+      const iFace = Bridge__factory.createInterface()
+      const log = encodeLog(iFace, 'MessageDelivered', [
+        BigNumber.from(123456),
+        hash1,
+        address1,
+        9,
+        address2,
+        hash2,
+        BigNumber.from(30000000000),
+        BigNumber.from(1660000000),
+      ])
+      expectArgs(decodeMessageDeliveredEvent(log), iFace.parseLog(log).args)
+    })
+
+    it('decodes InboxMessageDelivered as ethers does', () => {
+      const iFace = Inbox__factory.createInterface()
+      const log = encodeLog(iFace, 'InboxMessageDelivered(uint256,bytes)', [
+        BigNumber.from(123456),
+        bytesOfLength(200),
+      ])
+      expectArgs(
+        decodeInboxMessageDeliveredEvent(log),
+        iFace.parseLog(log).args
+      )
+    })
+
+    it('decodes RedeemScheduled as ethers does', () => {
+      const iFace = ArbRetryableTx__factory.createInterface()
+      const log = encodeLog(iFace, 'RedeemScheduled', [
+        hash1,
+        hash2,
+        BigNumber.from(2),
+        BigNumber.from('18446744073709551615'),
+        address1,
+        BigNumber.from(1),
+        BigNumber.from(0),
+      ])
+      expectArgs(decodeRedeemScheduledEvent(log), iFace.parseLog(log).args)
+    })
+
+    it('throws on logs of other events', () => {
+      const log = encodeLog(
+        ArbRetryableTx__factory.createInterface(),
+        'RedeemScheduled',
+        [hash1, hash2, 2, 3, address1, 1, 0]
+      )
+      expect(() => decodeL2ToL1TxEvent(log)).to.throw()
+      expect(() =>
+        decodeRedeemScheduledEvent({ ...log, topics: log.topics.slice(0, 3) })
+      ).to.throw()
+    })
+  })
+})
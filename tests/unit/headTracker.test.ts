@@ -0,0 +1,160 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { expect } from 'chai'
+import { Provider } from '@ethersproject/abstract-provider'
+
+import { HeadTracker } from '../../src/lib/utils/headTracker'
+
+const wait = (ms: number) => new Promise(resolve => setTimeout(resolve, ms))
+
+describe('HeadTracker', () => {
+  // a provider whose latest block is set by the test, recording block subscriptions
+  const createProvider = () => {
+    const chain = {
+      head: 10,
+      getBlockCalls: 0,
+      listeners: [] as ((blockNumber: number) => void)[],
+      on: 0,
+      off: 0,
+    }
+    const provider = {
+      getBlock: async () => {
+        chain.getBlockCalls++
+        return {
+          number: chain.head,
+          hash: `0x${chain.head.toString(16)}`,
+          timestamp: chain.head * 12,
+        }
+      },
+      on: (_: string, listener: (blockNumber: number) => void) => {
+        chain.on++
+        chain.listeners.push(listener)
+      },
+      off: (_: string, listener: (blockNumber: number) => void) => {
+        chain.off++
+        chain.listeners = chain.listeners.filter(l => l !== listener)
+      },
+    } as unknown as Provider
+    return { chain, provider }
+  }
+
+  it('shares the tracker of a provider', () => {
+    const { provider } = createProvider()
+    const tracker = HeadTracker.forProvider(provider)
+
+    expect(HeadTracker.forProvider(provider)).to.eq(tracker)
+    HeadTracker.forProvider(provider, { maxStalenessMs: 5 })
+    expect(tracker.options).to.deep.eq({ maxStalenessMs: 5 })
+  })
+
+  it('serves the head from memory until it is stale', async () => {
+    const { chain, provider } = createProvider()
+    const tracker = new HeadTracker(provider, { maxStalenessMs: 50 })
+
+    expect(await tracker.getBlockNumber()).to.eq(10)
+    chain.head = 11
+    expect(await tracker.getBlockNumber()).to.eq(10)
+    expect(chain.getBlockCalls).to.eq(1)
+
+    await wait(60)
+    expect(await tracker.getBlockNumber()).to.eq(11)
+    expect(chain.getBlockCalls).to.eq(2)
+
+    // the staleness bound can be overridden per read
+    chain.head = 12
+    await wait(5)
+    expect(await tracker.getBlockNumber(0)).to.eq(12)
+    expect(chain.getBlockCalls).to.eq(3)
+  })
+
+  it('shares fetches in flight', async () => {
+    const { chain, provider } = createProvider()
+    const tracker = new HeadTracker(provider)
+
+    const heads = await Promise.all([
+      tracker.getHead(),
+      tracker.getBlockNumber(),
+      tracker.getTimestamp(),
+    ])
+
+    expect(heads[0].number).to.eq(10)
+    expect(heads[1]).to.eq(10)
+    expect(heads[2]).to.eq(120)
+    expect(chain.getBlockCalls).to.eq(1)
+  })
+
+  it('never moves the head backwards', async () => {
+    const { chain, provider } = createProvider()
+    const tracker = new HeadTracker(provider, { maxStalenessMs: 0 })
+    expect(await tracker.getBlockNumber()).to.eq(10)
+
+    // a lagging node returns an older head
+    chain.head = 8
+    await wait(5)
+    expect(await tracker.getBlockNumber()).to.eq(10)
+    expect(chain.getBlockCalls).to.eq(2)
+
+    chain.head = 13
+    await wait(5)
+    expect(await tracker.getBlockNumber()).to.eq(13)
+  })
+
+  it('refetches the head on new blocks while followed', async () => {
+    const { chain, provider } = createProvider()
+    const tracker = new HeadTracker(provider, { maxStalenessMs: 60000 })
+    tracker.follow()
+    expect(await tracker.getBlockNumber()).to.eq(10)
+
+    // blocks at or before the head are ignored
+    chain.listeners.forEach(l => l(10))
+    expect(chain.getBlockCalls).to.eq(1)
+
+    chain.head = 11
+    chain.listeners.forEach(l => l(11))
+    await wait(0)
+    expect(chain.getBlockCalls).to.eq(2)
+    expect(await tracker.getBlockNumber()).to.eq(11)
+    expect(chain.getBlockCalls).to.eq(2)
+    tracker.unfollow()
+  })
+
+  it('only unsubscribes once every follower has unfollowed', () => {
+    const { chain, provider } = createProvider()
+    const tracker = new HeadTracker(provider)
+
+    tracker.follow()
+    tracker.follow()
+    expect(chain.on).to.eq(1)
+
+    tracker.unfollow()
+    expect(chain.off).to.eq(0)
+    expect(chain.listeners.length).to.eq(1)
+
+    tracker.unfollow()
+    expect(chain.off).to.eq(1)
+    expect(chain.listeners.length).to.eq(0)
+
+    // unmatched unfollows are ignored
+    tracker.unfollow()
+    expect(chain.off).to.eq(1)
+    tracker.follow()
+    expect(chain.on).to.eq(2)
+    expect(chain.listeners.length).to.eq(1)
+  })
+})
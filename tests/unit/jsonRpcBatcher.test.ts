@@ -0,0 +1,257 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { expect } from 'chai'
+import { createServer, Server } from 'http'
+import { AddressInfo } from 'net'
+import { providers } from 'ethers'
+import { Provider } from '@ethersproject/abstract-provider'
+
+import {
+  getTransactionReceipts,
+  JsonRpcBatcher,
+} from '../../src/lib/utils/jsonRpcBatcher'
+
+type JsonRpcRequest = { id: number; method: string; params: any[] }
+
+describe('JsonRpcBatcher', () => {
+  // a JSON-RPC endpoint that echoes the first param, fails requests for the
+  // 'fail' method, rejects batches larger than maxBatchSize, and answers
+  // batches with batchError when it is set
+  let server: Server
+  let url: string
+  let bodies: (JsonRpcRequest | JsonRpcRequest[])[]
+  let maxBatchSize: number
+  let batchError: 'disconnect' | { code: number; message: string } | undefined
+
+  const respond = (req: JsonRpcRequest) =>
+    req.method === 'fail'
+      ? {
+          jsonrpc: '2.0',
+          id: req.id,
+          error: { code: -32000, message: `failed ${req.params[0]}` },
+        }
+      : { jsonrpc: '2.0', id: req.id, result: req.params[0] }
+
+  before(async () => {
+    server = createServer((req, res) => {
+      let body = ''
+      req.on('data', chunk => (body += chunk))
+      req.on('end', () => {
+        const payload = JSON.parse(body)
+        bodies.push(payload)
+        if (Array.isArray(payload) && payload.length > maxBatchSize) {
+          res.writeHead(413)
+          res.end()
+          return
+        }
+        if (Array.isArray(payload) && batchError === 'disconnect') {
+          req.socket.destroy()
+          return
+        }
+        if (Array.isArray(payload) && batchError) {
+          res.writeHead(200, { 'Content-Type': 'application/json' })
+          res.end(
+            JSON.stringify({ jsonrpc: '2.0', id: null, error: batchError })
+          )
+          return
+        }
+        res.writeHead(200, { 'Content-Type': 'application/json' })
+        res.end(
+          JSON.stringify(
+            Array.isArray(payload) ? payload.map(respond) : respond(payload)
+          )
+        )
+      })
+    })
+    await new Promise<void>(resolve => server.listen(0, '127.0.0.1', resolve))
+    url = `http://127.0.0.1:${(server.address() as AddressInfo).port}`
+  })
+
+  after(() => server.close())
+
+  beforeEach(() => {
+    bodies = []
+    maxBatchSize = Infinity
+    batchError = undefined
+  })
+
+  const createBatcher = () =>
+    new JsonRpcBatcher(
+      new providers.StaticJsonRpcProvider(url, { chainId: 1, name: 'test' })
+    )
+
+  const sendAll = (batcher: JsonRpcBatcher, count: number, method = 'echo') =>
+    Promise.all(
+      Array.from({ length: count }, (_, i) => batcher.send(method, [i]))
+    )
+
+  it('sends requests made in the same tick as one batch', async () => {
+    const batcher = createBatcher()
+
+    expect(await sendAll(batcher, 5)).to.deep.eq([0, 1, 2, 3, 4])
+    expect(bodies.length).to.eq(1)
+    expect((bodies[0] as JsonRpcRequest[]).length).to.eq(5)
+  })
+
+  it('splits batches larger than the max batch size', async () => {
+    const batcher = new JsonRpcBatcher(createBatcher().provider, {
+      maxBatchSize: 3,
+    })
+
+    expect(await sendAll(batcher, 7)).to.deep.eq([0, 1, 2, 3, 4, 5, 6])
+    expect(bodies.map(b => (Array.isArray(b) ? b.length : 1))).to.deep.eq([
+      3, 3, 1,
+    ])
+  })
+
+  it('splits batches that the endpoint rejects', async () => {
+    const batcher = createBatcher()
+    maxBatchSize = 15
+
+    const results = await sendAll(batcher, 40)
+
+    expect(results).to.deep.eq(Array.from({ length: 40 }, (_, i) => i))
+    // 40 is rejected, then both 20s, then the 10s are accepted
+    const sizes = bodies.map(b => (Array.isArray(b) ? b.length : 1))
+    expect(sizes).to.deep.eq([40, 20, 20, 10, 10, 10, 10])
+  })
+
+  it('splits batches with a batch size error', async () => {
+    const batcher = createBatcher()
+    batchError = { code: -32600, message: 'batch too large' }
+
+    expect(await sendAll(batcher, 12)).to.deep.eq(
+      Array.from({ length: 12 }, (_, i) => i)
+    )
+    const sizes = bodies.map(b => (Array.isArray(b) ? b.length : 1))
+    expect(sizes).to.deep.eq([12, 6, 6, ...Array(12).fill(1)])
+  })
+
+  it('sends individually when batches are not supported', async () => {
+    const batcher = createBatcher()
+    batchError = { code: -32600, message: 'invalid request' }
+
+    expect(await sendAll(batcher, 12)).to.deep.eq(
+      Array.from({ length: 12 }, (_, i) => i)
+    )
+    const sizes = bodies.map(b => (Array.isArray(b) ? b.length : 1))
+    expect(sizes).to.deep.eq([12, ...Array(12).fill(1)])
+  })
+
+  it('passes rate limit errors to all callers', async () => {
+    const batcher = createBatcher()
+    batchError = { code: -32005, message: 'rate limit exceeded' }
+
+    const results = await Promise.allSettled(
+      Array.from({ length: 20 }, (_, i) => batcher.send('echo', [i]))
+    )
+
+    results.forEach(r => {
+      expect(r.status).to.eq('rejected')
+      const reason = (r as PromiseRejectedResult).reason
+      expect(reason.message).to.eq('rate limit exceeded')
+      expect(reason.code).to.eq(-32005)
+    })
+    // not split or resent
+    expect(bodies.length).to.eq(1)
+  })
+
+  it('passes network errors to all callers', async () => {
+    const batcher = createBatcher()
+    batchError = 'disconnect'
+
+    const results = await Promise.allSettled(
+      Array.from({ length: 20 }, (_, i) => batcher.send('echo', [i]))
+    )
+
+    expect(results.map(r => r.status)).to.deep.eq(Array(20).fill('rejected'))
+    // the same error for every caller, without resending
+    const reasons = results.map(r => (r as PromiseRejectedResult).reason)
+    expect(new Set(reasons).size).to.eq(1)
+    expect(bodies.length).to.eq(1)
+  })
+
+  it('fails requests individually', async () => {
+    const batcher = createBatcher()
+
+    const results = await Promise.allSettled([
+      batcher.send('echo', [0]),
+      batcher.send('fail', [1]),
+      batcher.send('echo', [2]),
+    ])
+
+    expect(results[0]).to.deep.eq({ status: 'fulfilled', value: 0 })
+    expect(results[2]).to.deep.eq({ status: 'fulfilled', value: 2 })
+    expect(results[1].status).to.eq('rejected')
+    expect(
+      (results[1] as PromiseRejectedResult).reason.error.message
+    ).to.eq('failed 1')
+    // the failed request is resent on its own for the provider's error
+    expect(bodies.length).to.eq(2)
+    expect((bodies[1] as JsonRpcRequest).method).to.eq('fail')
+  })
+
+  it('sends individually without an http connection', async () => {
+    const sent: string[] = []
+    const provider = new providers.Web3Provider(
+      async (method: string, params?: any[]) => {
+        sent.push(method)
+        return params?.[0]
+      },
+      { chainId: 1, name: 'test' }
+    )
+    const batcher = new JsonRpcBatcher(provider)
+
+    expect(batcher.canBatch).to.be.false
+    expect(await sendAll(batcher, 3)).to.deep.eq([0, 1, 2])
+    expect(sent).to.deep.eq(['echo', 'echo', 'echo'])
+    expect(bodies.length).to.eq(0)
+  })
+
+  it('fixes the options of shared batchers when they are created', () => {
+    const provider = createBatcher().provider
+    const options = { maxBatchSize: 5 }
+
+    const batcher = JsonRpcBatcher.forProvider(provider, options)
+    expect(JsonRpcBatcher.forProvider(provider)).to.eq(batcher)
+    expect(JsonRpcBatcher.forProvider(provider, { maxBatchSize: 5 })).to.eq(
+      batcher
+    )
+    expect(() =>
+      JsonRpcBatcher.forProvider(provider, { maxBatchSize: 10 })
+    ).to.throw('already created with different options')
+    expect(batcher.options).to.eq(options)
+  })
+
+  it('only supports JSON-RPC providers', async () => {
+    const hashes = ['0x01', '0x02']
+    // eg. a FallbackProvider, which has no send
+    const provider = {
+      getTransactionReceipt: async (hash: string) =>
+        hash === '0x01' ? { transactionHash: hash } : null,
+    } as unknown as Provider
+
+    expect(JsonRpcBatcher.isSupported(provider)).to.be.false
+    expect(JsonRpcBatcher.isSupported(createBatcher().provider)).to.be.true
+    expect(await getTransactionReceipts(provider, hashes)).to.deep.eq([
+      { transactionHash: '0x01' },
+      null,
+    ])
+  })
+})
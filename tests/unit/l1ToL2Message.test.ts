@@ -0,0 +1,393 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { expect } from 'chai'
+import {
+  Filter,
+  Log,
+  Provider,
+  TransactionRequest,
+} from '@ethersproject/abstract-provider'
+import { BigNumber, constants, utils } from 'ethers'
+
+import { ArbRetryableTx__factory } from '../../src/lib/abi/factories/ArbRetryableTx__factory'
+import { Multicall2__factory } from '../../src/lib/abi/factories/Multicall2__factory'
+import { ARB_RETRYABLE_TX_ADDRESS } from '../../src/lib/dataEntities/constants'
+import { getL2Network } from '../../src/lib/dataEntities/networks'
+import {
+  EthDepositMessage,
+  EthDepositStatus,
+  L1ToL2Message,
+  L1ToL2MessageReader,
+  L1ToL2MessageStatus,
+} from '../../src/lib/message/L1ToL2Message'
+import { HeadTracker } from '../../src/lib/utils/headTracker'
+
+const wait = (ms: number) => new Promise(resolve => setTimeout(resolve, ms))
+
+describe('L1ToL2Message', () => {
+  const iFace = ArbRetryableTx__factory.createInterface()
+  const multicallIface = Multicall2__factory.createInterface()
+  const timestampOf = (blockNumber: number) => 1000000 + blockNumber * 10
+  const retryTx = (i: number) => utils.id(`retry ${i}`)
+
+  // an L2 chain of ArbRetryableTx logs, receipts and ticket timeouts,
+  // served by a minimal provider
+  const createChain = async () => {
+    const l2Network = await getL2Network(42161)
+    const multicallAddr = l2Network.tokenBridge.l2Multicall
+    const chain = {
+      head: 100000,
+      logs: [] as Log[],
+      receipts: new Map<string, { status: number; logs?: Log[] }>(),
+      timeouts: new Map<string, number>(),
+      getLogsRanges: [] as number[][],
+      receiptLookups: [] as string[],
+      multicalls: 0,
+      timeoutCalls: 0,
+      // getLogs requests from this block onwards are answered late
+      slowFromBlock: Number.MAX_SAFE_INTEGER,
+    }
+    // reverts for tickets that do not exist
+    const getTimeout = (callData: string) => {
+      const [ticketId] = iFace.decodeFunctionData('getTimeout', callData)
+      const timeout = chain.timeouts.get(ticketId)
+      if (timeout === undefined) throw new Error('execution reverted')
+      return iFace.encodeFunctionResult('getTimeout', [timeout])
+    }
+    const provider = {
+      _isProvider: true,
+      getNetwork: async () => ({ chainId: 42161, name: 'arbitrum' }),
+      getBlockNumber: async () => chain.head,
+      getBlock: async (tag: number | string) => {
+        const number = tag === 'latest' ? chain.head : (tag as number)
+        return {
+          number,
+          hash: utils.hexZeroPad(utils.hexlify(number), 32),
+          timestamp: timestampOf(number),
+        }
+      },
+      getLogs: async (filter: Filter) => {
+        const fromBlock = filter.fromBlock as number
+        const toBlock = filter.toBlock as number
+        chain.getLogsRanges.push([fromBlock, toBlock])
+        if (fromBlock >= chain.slowFromBlock) await wait(20)
+        const [names, ticketId] = filter.topics!
+        return chain.logs.filter(
+          l =>
+            l.blockNumber >= fromBlock &&
+            l.blockNumber <= toBlock &&
+            (names as string[]).includes(l.topics[0]) &&
+            l.topics[1] === ticketId
+        )
+      },
+      getTransactionReceipt: async (txHash: string) => {
+        chain.receiptLookups.push(txHash)
+        const receipt = chain.receipts.get(txHash)
+        return receipt === undefined
+          ? null
+          : { transactionHash: txHash, blockNumber: 1, logs: [], ...receipt }
+      },
+      call: async (tx: TransactionRequest) => {
+        const data = tx.data as string
+        if (tx.to !== multicallAddr) {
+          chain.timeoutCalls++
+          return getTimeout(data)
+        }
+        chain.multicalls++
+        const [, calls] = multicallIface.decodeFunctionData(
+          'tryAggregate',
+          data
+        )
+        return multicallIface.encodeFunctionResult('tryAggregate', [
+          calls.map((c: { callData: string }) => {
+            try {
+              return [true, getTimeout(c.callData)]
+            } catch (err) {
+              return [false, '0x']
+            }
+          }),
+        ])
+      },
+    } as unknown as Provider
+    HeadTracker.forProvider(provider, { maxStalenessMs: 0 })
+
+    const createLog = (blockNumber: number, name: string, args: any[]): Log => {
+      const { data, topics } = iFace.encodeEventLog(iFace.getEvent(name), args)
+      return {
+        blockNumber,
+        blockHash: utils.hexZeroPad(utils.hexlify(blockNumber), 32),
+        transactionIndex: 0,
+        removed: false,
+        address: ARB_RETRYABLE_TX_ADDRESS,
+        data,
+        topics,
+        transactionHash: utils.id(`tx ${chain.logs.length}`),
+        logIndex: chain.logs.length,
+      }
+    }
+    const addLog = (blockNumber: number, name: string, args: any[]) =>
+      chain.logs.push(createLog(blockNumber, name, args))
+    const redeemScheduledArgs = (ticketId: string, retryTxHash: string) => [
+      ticketId,
+      retryTxHash,
+      0,
+      100000,
+      constants.AddressZero,
+      0,
+      0,
+    ]
+    const redeem = (
+      blockNumber: number,
+      ticketId: string,
+      retryTxHash: string,
+      status: number
+    ) => {
+      addLog(
+        blockNumber,
+        'RedeemScheduled',
+        redeemScheduledArgs(ticketId, retryTxHash)
+      )
+      chain.receipts.set(retryTxHash, { status })
+    }
+    // the creation receipt of a ticket, along with its auto redeem if any
+    const create = (
+      ticketId: string,
+      status: number,
+      autoRedeem?: { retryTxHash: string; status: number }
+    ) => {
+      const logs = autoRedeem
+        ? [
+            createLog(
+              1,
+              'RedeemScheduled',
+              redeemScheduledArgs(ticketId, autoRedeem.retryTxHash)
+            ),
+          ]
+        : []
+      chain.receipts.set(ticketId, { status, logs })
+      if (autoRedeem) {
+        chain.receipts.set(autoRedeem.retryTxHash, {
+          status: autoRedeem.status,
+        })
+      }
+    }
+    const extend = (
+      blockNumber: number,
+      ticketId: string,
+      newTimeout: number
+    ) => addLog(blockNumber, 'LifetimeExtended', [ticketId, newTimeout])
+
+    const message = (i: number) =>
+      L1ToL2Message.fromEventComponents(
+        provider,
+        42161,
+        constants.AddressZero,
+        BigNumber.from(i),
+        BigNumber.from(1000000000),
+        {
+          destAddress: constants.AddressZero,
+          l2CallValue: BigNumber.from(0),
+          l1Value: BigNumber.from(0),
+          maxSubmissionFee: BigNumber.from(0),
+          excessFeeRefundAddress: constants.AddressZero,
+          callValueRefundAddress: constants.AddressZero,
+          gasLimit: BigNumber.from(100000),
+          maxFeePerGas: BigNumber.from(1000000000),
+          data: '0x',
+        }
+      )
+
+    return { chain, provider, create, redeem, extend, message }
+  }
+
+  describe('searchForRedeem', () => {
+    // 100000 blocks over 1000000 seconds, so each window covers 8640 blocks
+    const windows = [
+      [0, 8639],
+      [8640, 17279],
+      [17280, 25919],
+      [25920, 34559],
+    ]
+
+    it('stops the windows in flight once the redeem is found', async () => {
+      const { chain, redeem, message } = await createChain()
+      const ticket = message(1)
+      const ticketId = ticket.retryableCreationId
+      redeem(100, ticketId, retryTx(1), 1)
+      redeem(9000, ticketId, retryTx(2), 0)
+      redeem(18000, ticketId, retryTx(3), 0)
+      chain.slowFromBlock = 8640
+
+      const result = await ticket['searchForRedeem'](0, 7 * 24 * 60 * 60)
+      expect(result.status).to.eq(L1ToL2MessageStatus.REDEEMED)
+      expect(
+        (result as { l2TxReceipt: { transactionHash: string } }).l2TxReceipt
+          .transactionHash
+      ).to.eq(retryTx(1))
+
+      // let the later windows finish their log queries
+      await wait(50)
+      expect(chain.getLogsRanges).to.deep.eq(windows)
+      // their redeems are not looked up
+      expect(chain.receiptLookups).to.deep.eq([retryTx(1)])
+    })
+
+    it('searches up to the extended timeout', async () => {
+      const { chain, redeem, extend, message } = await createChain()
+      const redeemed = message(1)
+      const expired = message(2)
+      // the lifetime ends within the second window, unless it is extended
+      const lifetime = 100000
+      for (const ticket of [redeemed, expired]) {
+        extend(9000, ticket.retryableCreationId, timestampOf(30000))
+      }
+      redeem(28000, redeemed.retryableCreationId, retryTx(1), 1)
+
+      const result = await redeemed['searchForRedeem'](0, lifetime)
+      expect(result.status).to.eq(L1ToL2MessageStatus.REDEEMED)
+
+      chain.getLogsRanges = []
+      expect((await expired['searchForRedeem'](0, lifetime)).status).to.eq(
+        L1ToL2MessageStatus.EXPIRED
+      )
+      // the window ending after the extended timeout is the last one consumed
+      expect(chain.getLogsRanges.slice(0, 4)).to.deep.eq(windows)
+      expect(chain.getLogsRanges.length).to.eq(7)
+    })
+  })
+
+  describe('bulkStatus', () => {
+    it('resolves the statuses of many messages at once', async () => {
+      const { chain, create, redeem, message } = await createChain()
+      const messages = [1, 2, 3, 4, 5, 6].map(message)
+      const [
+        notCreated,
+        creationFailed,
+        autoRedeemed,
+        open,
+        manuallyRedeemed,
+        expired,
+      ] = messages.map(m => m.retryableCreationId)
+      create(creationFailed, 0)
+      create(autoRedeemed, 1, { retryTxHash: retryTx(3), status: 1 })
+      create(open, 1, { retryTxHash: retryTx(4), status: 0 })
+      chain.timeouts.set(open, timestampOf(chain.head) + 1000)
+      create(manuallyRedeemed, 1, { retryTxHash: retryTx(5), status: 0 })
+      redeem(200, manuallyRedeemed, retryTx(6), 1)
+      create(expired, 1)
+      const statuses = [
+        L1ToL2MessageStatus.NOT_YET_CREATED,
+        L1ToL2MessageStatus.CREATION_FAILED,
+        L1ToL2MessageStatus.REDEEMED,
+        L1ToL2MessageStatus.FUNDS_DEPOSITED_ON_L2,
+        L1ToL2MessageStatus.REDEEMED,
+        L1ToL2MessageStatus.EXPIRED,
+      ]
+
+      expect(await L1ToL2MessageReader.bulkStatus(messages)).to.deep.eq(
+        statuses
+      )
+      // whether the tickets exist is checked in a single multicall
+      expect(chain.multicalls).to.eq(1)
+      expect(chain.receiptLookups).to.include(retryTx(6))
+
+      // redeemed and creation failed results are remembered
+      chain.receiptLookups = []
+      chain.multicalls = 0
+      expect(await L1ToL2MessageReader.bulkStatus(messages)).to.deep.eq(
+        statuses
+      )
+      expect(chain.multicalls).to.eq(1)
+      expect(chain.receiptLookups).to.include(notCreated)
+      for (const hash of [
+        creationFailed,
+        autoRedeemed,
+        manuallyRedeemed,
+        retryTx(3),
+        retryTx(6),
+      ]) {
+        expect(chain.receiptLookups).to.not.include(hash)
+      }
+    })
+
+    it('makes no requests when there are no messages', async () => {
+      expect(await L1ToL2MessageReader.bulkStatus([])).to.deep.eq([])
+    })
+
+    it('rejects messages on different providers', async () => {
+      const first = (await createChain()).message(1)
+      const second = (await createChain()).message(2)
+
+      let error: Error | undefined
+      await L1ToL2MessageReader.bulkStatus([first, second]).catch(
+        err => (error = err)
+      )
+      expect(error!.message).to.eq(
+        'All messages must use the same L2 provider.'
+      )
+    })
+  })
+
+  describe('EthDepositMessage.bulkStatus', () => {
+    const deposit = (provider: Provider, messageNumber: number) =>
+      new EthDepositMessage(
+        provider,
+        42161,
+        BigNumber.from(messageNumber),
+        constants.AddressZero,
+        constants.AddressZero,
+        BigNumber.from(1000)
+      )
+
+    it('resolves the statuses of many deposits at once', async () => {
+      const { chain, provider } = await createChain()
+      const deposited = deposit(provider, 1)
+      const pending = deposit(provider, 2)
+      chain.receipts.set(deposited.l2DepositTxHash, { status: 1 })
+
+      expect(
+        await EthDepositMessage.bulkStatus([deposited, pending])
+      ).to.deep.eq([EthDepositStatus.DEPOSITED, EthDepositStatus.PENDING])
+      expect(chain.receiptLookups).to.deep.eq([
+        deposited.l2DepositTxHash,
+        pending.l2DepositTxHash,
+      ])
+
+      // the receipts found are kept for wait
+      chain.receiptLookups = []
+      expect((await deposited.wait())!.transactionHash).to.eq(
+        deposited.l2DepositTxHash
+      )
+      expect(chain.receiptLookups).to.deep.eq([])
+    })
+
+    it('rejects deposits on different providers', async () => {
+      const first = deposit((await createChain()).provider, 1)
+      const second = deposit((await createChain()).provider, 2)
+
+      let error: Error | undefined
+      await EthDepositMessage.bulkStatus([first, second]).catch(
+        err => (error = err)
+      )
+      expect(error!.message).to.eq(
+        'All messages must use the same L2 provider.'
+      )
+    })
+  })
+})
@@ -0,0 +1,243 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { expect } from 'chai'
+import {
+  Provider,
+  TransactionRequest,
+} from '@ethersproject/abstract-provider'
+import { Signer } from '@ethersproject/abstract-signer'
+import { BigNumber, constants, utils } from 'ethers'
+
+import { Multicall2__factory } from '../../src/lib/abi/factories/Multicall2__factory'
+import { Outbox__factory } from '../../src/lib/abi/factories/Outbox__factory'
+import { L2ToL1MessageStatus } from '../../src/lib/dataEntities/message'
+import { getL2Network } from '../../src/lib/dataEntities/networks'
+import { L2ToL1MessageBatchExecutor } from '../../src/lib/message/L2ToL1MessageBatchExecutor'
+import { L2ToL1MessageReaderNitro } from '../../src/lib/message/L2ToL1MessageNitro'
+
+const outboxIface = Outbox__factory.createInterface()
+const multicallIface = Multicall2__factory.createInterface()
+
+const positionOf = (executeData: string) =>
+  (
+    outboxIface.decodeFunctionData(
+      'executeTransaction',
+      executeData
+    )[1] as BigNumber
+  ).toNumber()
+
+/**
+ * Records the transactions it sends, and fails to send executions of the given positions
+ */
+class TestSigner extends Signer {
+  public readonly sent: TransactionRequest[] = []
+  public failingPositions: number[] = []
+
+  public constructor(
+    public readonly provider: Provider,
+    private readonly baseNonce: number
+  ) {
+    super()
+  }
+
+  public async getAddress(): Promise<string> {
+    return '0x0000000000000000000000000000000000000001'
+  }
+
+  public async getTransactionCount(): Promise<number> {
+    return this.baseNonce + this.sent.length
+  }
+
+  public async sendTransaction(
+    transaction: utils.Deferrable<TransactionRequest>
+  ): Promise<any> {
+    const tx = await utils.resolveProperties(transaction)
+    const data = tx.data as string
+    if (
+      data.startsWith(outboxIface.getSighash('executeTransaction')) &&
+      this.failingPositions.includes(positionOf(data))
+    ) {
+      throw new Error('send failed')
+    }
+    this.sent.push(tx)
+    const hash = utils.id(`tx ${this.sent.length}`)
+    return {
+      ...tx,
+      hash,
+      wait: async () => ({ transactionHash: hash, status: 1, logs: [] }),
+    }
+  }
+
+  public signMessage(): Promise<string> {
+    throw new Error('not supported')
+  }
+
+  public signTransaction(): Promise<string> {
+    throw new Error('not supported')
+  }
+
+  public connect(): Signer {
+    return this
+  }
+}
+
+describe('L2ToL1MessageBatchExecutor', () => {
+  const getStatuses = L2ToL1MessageReaderNitro.getStatuses
+  const getOutboxProofs = L2ToL1MessageReaderNitro.getOutboxProofs
+
+  afterEach(() => {
+    L2ToL1MessageReaderNitro.getStatuses = getStatuses
+    L2ToL1MessageReaderNitro.getOutboxProofs = getOutboxProofs
+  })
+
+  const message = (position: number) =>
+    ({
+      event: {
+        position: BigNumber.from(position),
+        caller: constants.AddressZero,
+        destination: constants.AddressZero,
+        arbBlockNum: BigNumber.from(1),
+        ethBlockNum: BigNumber.from(1),
+        timestamp: BigNumber.from(1),
+        callvalue: BigNumber.from(0),
+        data: '0x',
+      },
+    } as unknown as L2ToL1MessageReaderNitro)
+
+  // executions of the positions in failingEstimates fail gas estimation, and only
+  // the positions in spent are seen as executed after a multicall is mined
+  const createExecutor = (
+    statuses: L2ToL1MessageStatus[],
+    options: { failingEstimates?: number[]; spent?: number[] } = {}
+  ) => {
+    L2ToL1MessageReaderNitro.getStatuses = async () => statuses
+    L2ToL1MessageReaderNitro.getOutboxProofs = async (_, messages) =>
+      messages.map(() => [constants.HashZero])
+
+    const estimates: TransactionRequest[] = []
+    const l1Provider = {
+      _isProvider: true,
+      estimateGas: async (tx: TransactionRequest) => {
+        estimates.push(tx)
+        if (options.failingEstimates?.includes(positionOf(tx.data as string))) {
+          throw new Error('execution reverted')
+        }
+        return BigNumber.from(4000000)
+      },
+      call: async (tx: TransactionRequest) => {
+        const [position] = outboxIface.decodeFunctionData(
+          'isSpent',
+          tx.data as string
+        )
+        return outboxIface.encodeFunctionResult('isSpent', [
+          !!options.spent?.includes(position.toNumber()),
+        ])
+      },
+      resolveName: async (name: string) => name,
+    } as unknown as Provider
+    const l2Provider = {
+      getNetwork: async () => ({ chainId: 42161, name: 'arbitrum' }),
+    } as unknown as Provider
+
+    const signer = new TestSigner(l1Provider, 5)
+    const executor = new L2ToL1MessageBatchExecutor(signer, l2Provider)
+    return { executor, signer, estimates }
+  }
+
+  it('pipelines the executions of confirmed messages', async () => {
+    const { executor, signer } = createExecutor([
+      L2ToL1MessageStatus.CONFIRMED,
+      L2ToL1MessageStatus.UNCONFIRMED,
+      L2ToL1MessageStatus.CONFIRMED,
+      L2ToL1MessageStatus.CONFIRMED,
+    ])
+    signer.failingPositions = [3]
+    const l2Network = await getL2Network(42161)
+
+    const results = await executor.execute([1, 2, 3, 4].map(message))
+
+    expect(signer.sent.map(tx => tx.to)).to.deep.eq([
+      l2Network.ethBridge.outbox,
+      l2Network.ethBridge.outbox,
+    ])
+    expect(signer.sent.map(tx => positionOf(tx.data as string))).to.deep.eq([
+      1, 4,
+    ])
+    // the nonce is re-read after the failed send
+    expect(signer.sent.map(tx => tx.nonce)).to.deep.eq([5, 6])
+    expect(results.map(r => r.status)).to.deep.eq([
+      L2ToL1MessageStatus.CONFIRMED,
+      L2ToL1MessageStatus.UNCONFIRMED,
+      L2ToL1MessageStatus.CONFIRMED,
+      L2ToL1MessageStatus.CONFIRMED,
+    ])
+    expect(results.map(r => !!r.transaction)).to.deep.eq([
+      true,
+      false,
+      false,
+      true,
+    ])
+    expect(results[1].error).to.be.undefined
+    expect(results[2].error!.message).to.eq('send failed')
+  })
+
+  it('groups executions into multicalls sent by the multicall', async () => {
+    const { executor, signer, estimates } = createExecutor(
+      [1, 2, 3, 4].map(() => L2ToL1MessageStatus.CONFIRMED),
+      { failingEstimates: [2], spent: [1, 4] }
+    )
+    const l2Network = await getL2Network(42161)
+
+    const results = await executor.execute([1, 2, 3, 4].map(message), {
+      mode: 'multicall',
+      maxGasPerTransaction: 10000000,
+    })
+
+    // the executions are estimated as called by the multicall
+    expect(estimates.map(tx => tx.from)).to.deep.eq(
+      [1, 2, 3, 4].map(() => l2Network.tokenBridge.l1MultiCall)
+    )
+    expect(signer.sent.map(tx => tx.to)).to.deep.eq([
+      l2Network.tokenBridge.l1MultiCall,
+      l2Network.tokenBridge.l1MultiCall,
+    ])
+    expect(signer.sent.map(tx => tx.nonce)).to.deep.eq([5, 6])
+    // 4m gas each, so at most two executions fit in a multicall
+    expect(
+      signer.sent.map(tx =>
+        multicallIface
+          .decodeFunctionData('tryAggregate', tx.data as string)[1]
+          .map((c: { callData: string }) => positionOf(c.callData))
+      )
+    ).to.deep.eq([[1, 3], [4]])
+
+    expect(results.map(r => !!r.transaction)).to.deep.eq([
+      true,
+      false,
+      true,
+      true,
+    ])
+    expect(results[0].error).to.be.undefined
+    expect(results[1].error!.message).to.eq('execution reverted')
+    expect(results[2].error!.message).to.eq(
+      'Message was not executed by the multicall transaction.'
+    )
+    expect(results[3].error).to.be.undefined
+  })
+})
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { expect } from 'chai'
+import { Provider } from '@ethersproject/abstract-provider'
+import { BigNumber } from 'ethers'
+
+import {
+  L2ToL1MessageReaderNitro,
+  searchFirstNodeAfter,
+} from '../../src/lib/message/L2ToL1MessageNitro'
+
+describe('L2ToL1MessageNitro', () => {
+  describe('searchFirstNodeAfter', () => {
+    // node i has a send count of sendCounts[i], and each round of probes is recorded
+    const search = async (sendCounts: number[], position: number) => {
+      const rounds: number[][] = []
+      let round: number[] | undefined
+      const index = await searchFirstNodeAfter(
+        sendCounts.length,
+        BigNumber.from(position),
+        async i => {
+          // probes made in the same tick belong to the same round
+          if (!round) {
+            round = []
+            rounds.push(round)
+            Promise.resolve().then(() => (round = undefined))
+          }
+          round.push(i)
+          return BigNumber.from(sendCounts[i])
+        }
+      )
+      return { index, rounds }
+    }
+
+    const linearSearch = (sendCounts: number[], position: number) => {
+      const index = sendCounts.findIndex(s => s > position)
+      return index === -1 ? undefined : index
+    }
+
+    it('finds the first node with a greater send count', async () => {
+      // non decreasing, with runs of equal send counts
+      const sendCounts = Array.from({ length: 100 }, (_, i) => 3 * (i >> 1))
+      for (let position = -1; position <= 150; position++) {
+        const { index } = await search(sendCounts, position)
+        expect(index, `position ${position}`).to.eq(
+          linearSearch(sendCounts, position)
+        )
+      }
+    })
+
+    it('finds the node at any count', async () => {
+      for (let count = 1; count <= 20; count++) {
+        const sendCounts = Array.from({ length: count }, (_, i) => i + 1)
+        for (let position = 0; position <= count; position++) {
+          const { index } = await search(sendCounts, position)
+          expect(index, `count ${count}, position ${position}`).to.eq(
+            linearSearch(sendCounts, position)
+          )
+        }
+      }
+    })
+
+    it('returns undefined when there are no nodes', async () => {
+      const { index, rounds } = await search([], 0)
+      expect(index).to.be.undefined
+      expect(rounds).to.deep.eq([])
+    })
+
+    it('probes up to 8 nodes at once in each round', async () => {
+      const sendCounts = Array.from({ length: 4096 }, (_, i) => i + 1)
+
+      const { index, rounds } = await search(sendCounts, 1234)
+
+      expect(index).to.eq(1234)
+      expect(rounds.every(r => r.length <= 8)).to.be.true
+      // each round narrows the range by a factor of 8, 8^4 = 4096
+      expect(rounds.length).to.be.lessThan(6)
+      // the first round spans the whole range
+      expect(rounds[0]).to.deep.eq([
+        511, 1023, 1535, 2047, 2559, 3071, 3583, 4095,
+      ])
+    })
+
+    it('makes a single round when no node has a greater send count', async () => {
+      const sendCounts = Array.from({ length: 100 }, (_, i) => i)
+
+      const { index, rounds } = await search(sendCounts, 1000)
+
+      expect(index).to.be.undefined
+      expect(rounds.length).to.eq(1)
+      expect(rounds[0][rounds[0].length - 1]).to.eq(99)
+    })
+  })
+
+  describe('getFirstExecutableBlocks', () => {
+    it('does not look up the status of each message', async () => {
+      const l1Provider = { _isProvider: true } as unknown as Provider
+      const l2Provider = {
+        _isProvider: true,
+        getNetwork: async () => ({ chainId: 42161, name: 'arbitrum' }),
+      } as unknown as Provider
+      // confirmed messages, whose status would otherwise be looked up one by one
+      const messages = [1, 2, 3].map(
+        position =>
+          ({
+            event: { position: BigNumber.from(position) },
+            sendRootConfirmed: true,
+            status: async () => {
+              throw new Error('status looked up')
+            },
+          } as unknown as L2ToL1MessageReaderNitro)
+      )
+
+      expect(
+        await L2ToL1MessageReaderNitro.getFirstExecutableBlocks(
+          l1Provider,
+          l2Provider,
+          messages
+        )
+      ).to.deep.eq([null, null, null])
+    })
+  })
+})
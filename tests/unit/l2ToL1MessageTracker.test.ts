@@ -0,0 +1,406 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { expect } from 'chai'
+import {
+  Filter,
+  Log,
+  Provider,
+  TransactionRequest,
+} from '@ethersproject/abstract-provider'
+import { BigNumber, constants, utils } from 'ethers'
+
+import { Outbox__factory } from '../../src/lib/abi/factories/Outbox__factory'
+import { RollupUserLogic__factory } from '../../src/lib/abi/factories/RollupUserLogic__factory'
+import { NodeCreatedEvent } from '../../src/lib/abi/RollupUserLogic'
+import { L2ToL1MessageStatus } from '../../src/lib/dataEntities/message'
+import { getL2Network, L2Network } from '../../src/lib/dataEntities/networks'
+import { L2ToL1MessageTracker } from '../../src/lib/message/L2ToL1MessageTracker'
+import {
+  RollupNodeCache,
+  RollupNodeInfo,
+  RollupNodeStatus,
+} from '../../src/lib/message/RollupNodeCache'
+import { FetchedEvent } from '../../src/lib/utils/eventFetcher'
+import { HeadTracker } from '../../src/lib/utils/headTracker'
+import { CallInput, MultiCaller } from '../../src/lib/utils/multicall'
+
+const rollupIface = RollupUserLogic__factory.createInterface()
+const outboxIface = Outbox__factory.createInterface()
+
+// zero values for any abi type, so that only the relevant fields need to be set
+const zeroValue = (param: utils.ParamType): any => {
+  if (param.baseType === 'tuple') return param.components.map(zeroValue)
+  if (param.baseType === 'array') {
+    return Array.from({ length: Math.max(param.arrayLength, 0) }, () =>
+      zeroValue(param.arrayChildren)
+    )
+  }
+  if (param.type === 'address') return constants.AddressZero
+  if (param.type === 'bool') return false
+  if (param.type === 'bytes') return '0x'
+  if (param.type.startsWith('bytes')) {
+    return utils.hexZeroPad('0x', Number(param.type.slice(5)))
+  }
+  return 0
+}
+
+const withValues = (params: utils.ParamType[], values: Record<string, any>) =>
+  params.map(p => (p.name in values ? values[p.name] : zeroValue(p)))
+
+/**
+ * Resolves nodes from a fixed set instead of looking up their L2 blocks
+ */
+class TestNodeCache extends RollupNodeCache {
+  public readonly lookups: { nodeNum: number; status: RollupNodeStatus }[] = []
+
+  public constructor(private readonly nodeInfos: Map<number, RollupNodeInfo>) {
+    super()
+  }
+
+  public override async getNodeFromLog(
+    _: string,
+    log: FetchedEvent<NodeCreatedEvent>,
+    __: Provider,
+    status: RollupNodeStatus
+  ): Promise<RollupNodeInfo> {
+    const nodeNum = log.event.nodeNum.toNumber()
+    this.lookups.push({ nodeNum, status })
+    return this.nodeInfos.get(nodeNum)!
+  }
+}
+
+describe('L2ToL1MessageTracker', () => {
+  // an L1 chain holding a rollup's node events, served by a minimal provider
+  const createChain = (l2Network: L2Network, finalityDepth = 0) => {
+    const chain = {
+      head: 100,
+      latestConfirmed: 0,
+      logs: [] as Log[],
+      nodeInfos: new Map<number, RollupNodeInfo>(),
+      getLogsRanges: [] as number[][],
+      latestConfirmedCalls: 0,
+      spent: new Set<number>(),
+      isSpentCalls: [] as number[],
+    }
+
+    const addLog = (blockNumber: number, name: string, args: any[]) => {
+      const { data, topics } = rollupIface.encodeEventLog(
+        rollupIface.getEvent(name),
+        args
+      )
+      chain.logs.push({
+        blockNumber,
+        blockHash: utils.hexZeroPad(utils.hexlify(blockNumber), 32),
+        transactionIndex: 0,
+        removed: false,
+        address: l2Network.ethBridge.rollup,
+        data,
+        topics,
+        transactionHash: utils.id(`tx ${chain.logs.length}`),
+        logIndex: chain.logs.length,
+      })
+    }
+    const createNode = (
+      nodeNum: number,
+      blockNumber: number,
+      sendCount: number
+    ) => {
+      addLog(
+        blockNumber,
+        'NodeCreated',
+        withValues(rollupIface.getEvent('NodeCreated').inputs, { nodeNum })
+      )
+      chain.nodeInfos.set(nodeNum, {
+        nodeNum,
+        createdAtBlock: blockNumber,
+        blockHash: utils.id(`block ${nodeNum}`),
+        sendRoot: utils.id(`send root ${nodeNum}`),
+        sendCount: BigNumber.from(sendCount),
+        l2BlockNumber: nodeNum * 1000,
+      })
+    }
+    const confirmNode = (nodeNum: number, blockNumber: number) =>
+      addLog(
+        blockNumber,
+        'NodeConfirmed',
+        withValues(rollupIface.getEvent('NodeConfirmed').inputs, { nodeNum })
+      )
+
+    const l1Provider = {
+      _isProvider: true,
+      getBlockNumber: async () => chain.head,
+      getBlock: async () => ({
+        number: chain.head,
+        hash: utils.hexZeroPad(utils.hexlify(chain.head), 32),
+        timestamp: chain.head * 12,
+      }),
+      getLogs: async (filter: Filter) => {
+        const fromBlock = filter.fromBlock as number
+        const toBlock = filter.toBlock as number
+        chain.getLogsRanges.push([fromBlock, toBlock])
+        const topic = filter.topics![0]
+        return chain.logs.filter(
+          l =>
+            l.blockNumber >= fromBlock &&
+            l.blockNumber <= toBlock &&
+            (Array.isArray(topic)
+              ? topic.includes(l.topics[0])
+              : topic === l.topics[0])
+        )
+      },
+      call: async (tx: TransactionRequest) => {
+        const data = tx.data as string
+        const fragment = rollupIface.getFunction(data.slice(0, 10))
+        if (fragment.name === 'latestConfirmed') {
+          chain.latestConfirmedCalls++
+          return rollupIface.encodeFunctionResult(fragment, [
+            chain.latestConfirmed,
+          ])
+        }
+        // getNode, only the creation block of the node is read
+        const [nodeNum] = rollupIface.decodeFunctionData(fragment, data)
+        const node = fragment.outputs![0]
+        return rollupIface.encodeFunctionResult(fragment, [
+          withValues(node.components, {
+            createdAtBlock: chain.nodeInfos.get(nodeNum.toNumber())!
+              .createdAtBlock,
+          }),
+        ])
+      },
+      resolveName: async (name: string) => name,
+    } as unknown as Provider
+    HeadTracker.forProvider(l1Provider, { maxStalenessMs: 0 })
+
+    const multiCaller = {
+      multiCall: async (calls: CallInput<boolean>[]) =>
+        calls.map(c => {
+          const [position] = outboxIface.decodeFunctionData(
+            'isSpent',
+            c.encoder()
+          )
+          chain.isSpentCalls.push(position.toNumber())
+          return c.decoder(
+            outboxIface.encodeFunctionResult('isSpent', [
+              chain.spent.has(position.toNumber()),
+            ])
+          )
+        }),
+    } as unknown as MultiCaller
+
+    const nodeCache = new TestNodeCache(chain.nodeInfos)
+    const tracker = new L2ToL1MessageTracker(
+      l1Provider,
+      {} as Provider,
+      l2Network,
+      multiCaller,
+      { nodeCache, finalityDepth }
+    )
+    return { chain, tracker, nodeCache, createNode, confirmNode }
+  }
+
+  const position = (p: number) => ({ position: BigNumber.from(p) })
+
+  it('ingests the nodes from the latest confirmed node onwards', async () => {
+    const l2Network = await getL2Network(42161)
+    const { chain, tracker, nodeCache, createNode } = createChain(l2Network)
+    createNode(1, 50, 5)
+    createNode(2, 60, 10)
+    createNode(3, 70, 20)
+    createNode(4, 80, 30)
+    chain.latestConfirmed = 2
+
+    await tracker.sync()
+
+    // the sync starts at the creation block of the latest confirmed node
+    expect(chain.getLogsRanges).to.deep.eq([
+      [60, 100],
+      [60, 100],
+    ])
+    expect(nodeCache.lookups).to.deep.eq([
+      { nodeNum: 2, status: RollupNodeStatus.CONFIRMED },
+      { nodeNum: 3, status: RollupNodeStatus.UNRESOLVED },
+      { nodeNum: 4, status: RollupNodeStatus.UNRESOLVED },
+    ])
+    expect(tracker.getLatestConfirmedNode()!.nodeNum).to.eq(2)
+    expect(tracker.getLatestConfirmedNode()!.confirmed).to.be.true
+    expect(tracker.getNodeForPosition(BigNumber.from(9))!.nodeNum).to.eq(2)
+    expect(tracker.getNodeForPosition(BigNumber.from(10))!.nodeNum).to.eq(3)
+    expect(tracker.getNodeForPosition(BigNumber.from(29))!.nodeNum).to.eq(4)
+    expect(tracker.getNodeForPosition(BigNumber.from(30))).to.be.undefined
+
+    expect(await tracker.getSendProps(BigNumber.from(9))).to.deep.eq({
+      sendRootSize: BigNumber.from(10),
+      sendRootHash: utils.id('send root 2'),
+      sendRootConfirmed: true,
+    })
+    expect(await tracker.getSendProps(BigNumber.from(15))).to.deep.eq({
+      sendRootSize: BigNumber.from(30),
+      sendRootHash: utils.id('send root 4'),
+      sendRootConfirmed: false,
+    })
+    expect(await tracker.getSendProps(BigNumber.from(30))).to.deep.eq({})
+  })
+
+  it('moves messages from unconfirmed to confirmed to executed', async () => {
+    const l2Network = await getL2Network(42161)
+    const { chain, tracker, createNode, confirmNode } = createChain(l2Network)
+    createNode(1, 50, 10)
+    createNode(2, 60, 20)
+    chain.latestConfirmed = 1
+
+    // the first status lookup syncs
+    expect(
+      await tracker.getStatuses([position(5), position(15), position(25)])
+    ).to.deep.eq([
+      L2ToL1MessageStatus.CONFIRMED,
+      L2ToL1MessageStatus.UNCONFIRMED,
+      L2ToL1MessageStatus.UNCONFIRMED,
+    ])
+    // only confirmed messages are checked for execution
+    expect(chain.isSpentCalls).to.deep.eq([5])
+
+    chain.head = 110
+    confirmNode(2, 105)
+    chain.spent.add(5)
+    chain.isSpentCalls = []
+    await tracker.sync()
+
+    expect(
+      await tracker.getStatuses([position(5), position(15), position(25)])
+    ).to.deep.eq([
+      L2ToL1MessageStatus.EXECUTED,
+      L2ToL1MessageStatus.CONFIRMED,
+      L2ToL1MessageStatus.UNCONFIRMED,
+    ])
+    expect(chain.isSpentCalls).to.deep.eq([5, 15])
+
+    // executed messages are not checked again
+    chain.isSpentCalls = []
+    expect(await tracker.getStatus(position(5))).to.eq(
+      L2ToL1MessageStatus.EXECUTED
+    )
+    expect(chain.isSpentCalls).to.deep.eq([])
+  })
+
+  it('resumes syncing after the last synced block', async () => {
+    const l2Network = await getL2Network(42161)
+    const { chain, tracker, nodeCache, createNode, confirmNode } =
+      createChain(l2Network)
+    createNode(1, 50, 10)
+    chain.latestConfirmed = 1
+    await tracker.sync()
+
+    chain.getLogsRanges = []
+    chain.head = 120
+    createNode(2, 110, 20)
+    createNode(3, 115, 30)
+    confirmNode(2, 118)
+    await tracker.sync()
+
+    expect(chain.latestConfirmedCalls).to.eq(1)
+    expect(chain.getLogsRanges).to.deep.eq([
+      [101, 120],
+      [101, 120],
+    ])
+    // nodes already seen are not resolved again
+    expect(nodeCache.lookups.map(l => l.nodeNum)).to.deep.eq([1, 2, 3])
+    expect(tracker.getLatestConfirmedNode()!.nodeNum).to.eq(2)
+    // nodes before the latest confirmed node are dropped
+    expect(tracker.getNodeForPosition(BigNumber.from(5))!.nodeNum).to.eq(2)
+
+    // nothing is fetched when there are no new blocks
+    chain.getLogsRanges = []
+    await tracker.sync()
+    expect(chain.getLogsRanges).to.deep.eq([])
+  })
+
+  it('only syncs blocks behind the finality depth', async () => {
+    const l2Network = await getL2Network(42161)
+    const { chain, tracker, createNode, confirmNode } = createChain(
+      l2Network,
+      30
+    )
+    createNode(1, 50, 10)
+    createNode(2, 60, 20)
+    chain.latestConfirmed = 1
+    await tracker.sync()
+
+    expect(chain.getLogsRanges).to.deep.eq([
+      [50, 70],
+      [50, 70],
+    ])
+    expect(tracker.getNodeForPosition(BigNumber.from(15))!.nodeNum).to.eq(2)
+
+    // a confirmation within the last 30 blocks is not seen yet
+    chain.getLogsRanges = []
+    chain.head = 120
+    confirmNode(2, 95)
+    await tracker.sync()
+    expect(chain.getLogsRanges).to.deep.eq([
+      [71, 90],
+      [71, 90],
+    ])
+    expect(await tracker.getStatus(position(15))).to.eq(
+      L2ToL1MessageStatus.UNCONFIRMED
+    )
+
+    chain.head = 125
+    await tracker.sync()
+    expect(await tracker.getStatus(position(15))).to.eq(
+      L2ToL1MessageStatus.CONFIRMED
+    )
+  })
+
+  it('caches rejected siblings of confirmed nodes as rejected', async () => {
+    const l2Network = await getL2Network(42161)
+    const rollupAddress = l2Network.ethBridge.rollup
+    const { chain, tracker, nodeCache, createNode, confirmNode } =
+      createChain(l2Network)
+    createNode(1, 50, 10)
+    // nodes 2 and 3 are siblings, only one of them can be confirmed
+    createNode(2, 60, 20)
+    createNode(3, 70, 20)
+    chain.latestConfirmed = 1
+    await tracker.sync()
+
+    chain.head = 120
+    createNode(4, 115, 30)
+    confirmNode(3, 110)
+    chain.latestConfirmed = 3
+    await tracker.sync()
+
+    expect(nodeCache.lookups.map(l => l.status)).to.deep.eq([
+      RollupNodeStatus.CONFIRMED,
+      RollupNodeStatus.UNRESOLVED,
+      RollupNodeStatus.UNRESOLVED,
+      RollupNodeStatus.UNRESOLVED,
+    ])
+    expect(nodeCache.get(rollupAddress, 1)!.status).to.eq(
+      RollupNodeStatus.CONFIRMED
+    )
+    expect(nodeCache.get(rollupAddress, 2)!.status).to.eq(
+      RollupNodeStatus.REJECTED
+    )
+    expect(nodeCache.get(rollupAddress, 3)!.status).to.eq(
+      RollupNodeStatus.CONFIRMED
+    )
+    expect(nodeCache.get(rollupAddress, 4)).to.be.undefined
+    expect(tracker.getLatestConfirmedNode()!.nodeNum).to.eq(3)
+  })
+})
@@ -0,0 +1,230 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { expect } from 'chai'
+import { promises as fs } from 'fs'
+import { tmpdir } from 'os'
+import * as path from 'path'
+import { Log } from '@ethersproject/abstract-provider'
+
+import {
+  BlockRange,
+  InMemoryLogCacheStore,
+  LogCache,
+  LogCacheStore,
+} from '../../src/lib/utils/logCache'
+import { FileLogCacheStore } from '../../src/lib/utils/fileLogCacheStore'
+
+// one log every 10 blocks
+const createLogs = ({ fromBlock, toBlock }: BlockRange): Log[] => {
+  const logs: Log[] = []
+  for (let b = Math.ceil(fromBlock / 10) * 10; b <= toBlock; b += 10) {
+    logs.push({
+      blockNumber: b,
+      logIndex: 0,
+      blockHash: '0x' + b.toString(16).padStart(64, '0'),
+      transactionHash: '0x' + b.toString(16).padStart(64, '0'),
+      transactionIndex: 0,
+      address: '0x0000000000000000000000000000000000000064',
+      topics: [],
+      data: '0x',
+      removed: false,
+    })
+  }
+  return logs
+}
+
+const filter = { address: '0x0000000000000000000000000000000000000064' }
+const chainId = 42161
+
+const testStore = (createStore: () => Promise<LogCacheStore>) => {
+  it('only fetches missing ranges', async () => {
+    const cache = new LogCache(await createStore(), { finalityDepth: 0 })
+    const fetched: BlockRange[] = []
+    const getLogs = (range: BlockRange) =>
+      cache.getLogs(chainId, filter, range, 10000, async r => {
+        fetched.push(r)
+        return createLogs(r).reverse()
+      })
+
+    await getLogs({ fromBlock: 100, toBlock: 199 })
+    await getLogs({ fromBlock: 300, toBlock: 399 })
+    fetched.length = 0
+    const logs = await getLogs({ fromBlock: 0, toBlock: 499 })
+
+    expect(fetched.sort((a, b) => a.fromBlock - b.fromBlock)).to.deep.eq([
+      { fromBlock: 0, toBlock: 99 },
+      { fromBlock: 200, toBlock: 299 },
+      { fromBlock: 400, toBlock: 499 },
+    ])
+    expect(logs).to.deep.eq(createLogs({ fromBlock: 0, toBlock: 499 }))
+
+    fetched.length = 0
+    expect(await getLogs({ fromBlock: 150, toBlock: 351 })).to.deep.eq(
+      createLogs({ fromBlock: 150, toBlock: 351 })
+    )
+    expect(fetched).to.deep.eq([])
+  })
+
+  it('appends a chunk per fetched range', async () => {
+    const store = await createStore()
+    const cache = new LogCache(store, { finalityDepth: 0 })
+    const key = LogCache.getKey(chainId, filter)
+
+    for (let from = 0; from < 1000; from += 100) {
+      await cache.getLogs(
+        chainId,
+        filter,
+        { fromBlock: from, toBlock: from + 99 },
+        10000,
+        async r => createLogs(r)
+      )
+    }
+
+    const ranges = (await store.getRanges(key)).sort(
+      (a, b) => a.fromBlock - b.fromBlock
+    )
+    expect(ranges.length).to.eq(10)
+    expect(ranges[9]).to.deep.eq({ fromBlock: 900, toBlock: 999 })
+    const chunks = await store.getChunks(key, { fromBlock: 250, toBlock: 450 })
+    expect(chunks.map(c => c.range.fromBlock).sort()).to.deep.eq([
+      200, 300, 400,
+    ])
+  })
+
+  it('does not duplicate logs of concurrent requests', async () => {
+    const store = await createStore()
+    const cache = new LogCache(store, { finalityDepth: 0 })
+    const getLogs = (range: BlockRange) =>
+      cache.getLogs(chainId, filter, range, 10000, async r => createLogs(r))
+
+    await Promise.all([
+      getLogs({ fromBlock: 0, toBlock: 199 }),
+      getLogs({ fromBlock: 100, toBlock: 299 }),
+    ])
+
+    expect(await getLogs({ fromBlock: 0, toBlock: 299 })).to.deep.eq(
+      createLogs({ fromBlock: 0, toBlock: 299 })
+    )
+  })
+
+  it('limits the number of missing ranges fetched at once', async () => {
+    const cache = new LogCache(await createStore(), { finalityDepth: 0 })
+    for (let from = 100; from < 1000; from += 200) {
+      await cache.getLogs(
+        chainId,
+        filter,
+        { fromBlock: from, toBlock: from + 99 },
+        10000,
+        async r => createLogs(r)
+      )
+    }
+
+    let active = 0
+    let maxActive = 0
+    const logs = await cache.getLogs(
+      chainId,
+      filter,
+      { fromBlock: 0, toBlock: 999 },
+      10000,
+      async r => {
+        maxActive = Math.max(maxActive, ++active)
+        await new Promise(resolve => setTimeout(resolve, 5))
+        active--
+        return createLogs(r)
+      },
+      2
+    )
+
+    // 5 gaps, fetched 2 at a time
+    expect(maxActive).to.eq(2)
+    expect(logs).to.deep.eq(createLogs({ fromBlock: 0, toBlock: 999 }))
+  })
+}
+
+describe('LogCache', () => {
+  describe('in memory', () => {
+    testStore(async () => new InMemoryLogCacheStore())
+
+    it('evicts filters once over the max number of logs', async () => {
+      const store = new InMemoryLogCacheStore(25)
+      const chunk = (fromBlock: number) => ({
+        range: { fromBlock, toBlock: fromBlock + 99 },
+        logs: createLogs({ fromBlock, toBlock: fromBlock + 99 }),
+      })
+
+      // 10 logs and 1 chunk each
+      await store.addChunk('a', chunk(0))
+      await store.addChunk('b', chunk(0))
+      expect((await store.getRanges('a')).length).to.eq(1)
+      await store.addChunk('b', chunk(100))
+
+      expect(await store.getRanges('a')).to.deep.eq([])
+      expect((await store.getRanges('b')).length).to.eq(2)
+    })
+  })
+
+  describe('file', () => {
+    const dirs: string[] = []
+    const createStore = async () => {
+      const dir = await fs.mkdtemp(path.join(tmpdir(), 'log-cache-'))
+      dirs.push(dir)
+      return new FileLogCacheStore(dir)
+    }
+
+    after(async () => {
+      for (const dir of dirs) await fs.rm(dir, { recursive: true, force: true })
+    })
+
+    testStore(createStore)
+
+    it('keeps chunks across instances', async () => {
+      const store = await createStore()
+      const chunk = {
+        range: { fromBlock: 0, toBlock: 99 },
+        logs: createLogs({ fromBlock: 0, toBlock: 99 }),
+      }
+      await store.addChunk('a', chunk)
+
+      const reopened = new FileLogCacheStore(store.directory)
+      expect(await reopened.getRanges('a')).to.deep.eq([chunk.range])
+      expect(await reopened.getChunks('a', chunk.range)).to.deep.eq([chunk])
+      expect(await reopened.getRanges('b')).to.deep.eq([])
+      expect(await reopened.getChunks('b', chunk.range)).to.deep.eq([])
+    })
+
+    it('writes each chunk to its own file', async () => {
+      const store = await createStore()
+      for (const fromBlock of [0, 100, 200]) {
+        await store.addChunk('a', {
+          range: { fromBlock, toBlock: fromBlock + 99 },
+          logs: [],
+        })
+      }
+
+      const [dir] = await fs.readdir(store.directory)
+      const files = await fs.readdir(path.join(store.directory, dir))
+      expect(files.sort()).to.deep.eq([
+        '0-99.json',
+        '100-199.json',
+        '200-299.json',
+        'key.json',
+      ])
+    })
+  })
+})
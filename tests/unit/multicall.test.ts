@@ -1,11 +1,20 @@
 'use strict'
 
 import { getL2Network } from '../../src/lib/dataEntities/networks'
-import { providers } from 'ethers'
-import { mock, when, anything, instance, deepEqual } from 'ts-mockito'
+import { BigNumber, providers, utils } from 'ethers'
+import { Logger } from '@ethersproject/logger'
+import {
+  mock,
+  when,
+  anything,
+  instance,
+  deepEqual,
+  verify,
+} from 'ts-mockito'
 import { expect } from 'chai'
 
-import { MultiCaller } from '../../src'
+import { MultiCaller, CallInput } from '../../src'
+import { Multicall2__factory } from '../../src/lib/abi/factories/Multicall2__factory'
 
 describe('Multicall', () => {
   const createProviderMock = async (networkChoiceOverride?: number) => {
@@ -96,4 +105,99 @@ describe('Multicall', () => {
       'Failed to get token symbol from byte string'
     ).to.be.equal('UNI')
   })
+
+  describe('chunking', () => {
+    const multicallIface = Multicall2__factory.createInterface()
+    const multicallAddr = '0x108B25170319f38DbED14cA9716C54E5D1FF4623'
+
+    // echoes each call data back as its return data, optionally failing
+    // the whole aggregate with this error if it contains more than maxCalls calls
+    const createEchoProviderMock = (
+      maxCalls?: number,
+      error: Error = callException()
+    ) => {
+      const providerMock = mock(providers.JsonRpcProvider)
+      when(providerMock._isProvider).thenReturn(true)
+      when(providerMock.call(anything(), anything())).thenCall(
+        async (tx: { data: string }) => {
+          const [, calls] = multicallIface.decodeFunctionData(
+            'tryAggregate',
+            tx.data
+          )
+          if (maxCalls && calls.length > maxCalls) throw error
+          return multicallIface.encodeFunctionResult('tryAggregate', [
+            calls.map((c: { callData: string }) => [true, c.callData]),
+          ])
+        }
+      )
+      return { providerMock, provider: instance(providerMock) }
+    }
+
+    const callException = () =>
+      Object.assign(new Error('out of gas'), {
+        code: Logger.errors.CALL_EXCEPTION,
+      })
+
+    const createInputs = (count: number): CallInput<number>[] =>
+      Array.from({ length: count }, (_, i) => ({
+        targetAddr: multicallAddr,
+        encoder: () => utils.hexZeroPad(utils.hexlify(i + 1), 32),
+        decoder: (returnData: string) =>
+          BigNumber.from(returnData).toNumber(),
+      }))
+
+    it('splits calls by gas and returns results in input order', async () => {
+      const { providerMock, provider } = createEchoProviderMock()
+      const multicaller = new MultiCaller(provider, multicallAddr)
+
+      const res = await multicaller.multiCall(createInputs(10), false, {
+        gasPerCall: 100,
+        maxGas: 300,
+        parallelism: 2,
+      })
+
+      expect(res).to.deep.equal([1, 2, 3, 4, 5, 6, 7, 8, 9, 10])
+      verify(providerMock.call(anything(), anything())).times(4)
+    })
+
+    it('splits calls by call data size', async () => {
+      const { providerMock, provider } = createEchoProviderMock()
+      const multicaller = new MultiCaller(provider, multicallAddr, {
+        // each call is 4 words of overhead plus one word of data
+        maxCallDataSize: 5 * 32 * 5,
+      })
+
+      const res = await multicaller.multiCall(createInputs(12))
+
+      expect(res).to.deep.equal([1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12])
+      verify(providerMock.call(anything(), anything())).times(3)
+    })
+
+    it('bisects chunks that fail as a whole', async () => {
+      const { provider } = createEchoProviderMock(2)
+      const multicaller = new MultiCaller(provider, multicallAddr)
+
+      const res = await multicaller.multiCall(createInputs(7))
+
+      expect(res).to.deep.equal([1, 2, 3, 4, 5, 6, 7])
+    })
+
+    it('does not bisect chunks that fail with other errors', async () => {
+      const { providerMock, provider } = createEchoProviderMock(
+        2,
+        new Error('429 Too Many Requests')
+      )
+      const multicaller = new MultiCaller(provider, multicallAddr)
+
+      let error: Error | undefined
+      try {
+        await multicaller.multiCall(createInputs(7))
+      } catch (err) {
+        error = err as Error
+      }
+
+      expect(error?.message).to.eq('429 Too Many Requests')
+      verify(providerMock.call(anything(), anything())).once()
+    })
+  })
 })
@@ -0,0 +1,191 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { expect } from 'chai'
+import { providers, utils } from 'ethers'
+import { Logger } from '@ethersproject/logger'
+import { anything, instance, mock, when } from 'ts-mockito'
+
+import { MultiCallBatchProvider } from '../../src/lib/utils/multicallBatchProvider'
+import { Multicall2__factory } from '../../src/lib/abi/factories/Multicall2__factory'
+
+describe('MultiCallBatchProvider', () => {
+  const multicallIface = Multicall2__factory.createInterface()
+  const multicallAddr = '0x108B25170319f38DbED14cA9716C54E5D1FF4623'
+  const targetAddr = '0x9f8F72aA9304c8B593d555f12eF6589cC3A579A2'
+  const network = { chainId: 42161, name: 'arbitrum' }
+
+  const callData = (i: number) => utils.hexZeroPad(utils.hexlify(i), 32)
+
+  // echoes call data back as return data. Calls whose data is in failingData
+  // revert, and the aggregate itself throws aggregateError if it is set, or
+  // returns aggregateData
+  const createProviderMock = (
+    options: {
+      aggregateError?: Error
+      aggregateData?: string
+      failingData?: string[]
+    } = {}
+  ) => {
+    const sent: { method: string; params: any[] }[] = []
+    const providerMock = mock(providers.JsonRpcProvider)
+    when(providerMock.send(anything(), anything())).thenCall(
+      async (method: string, params: any[]) => {
+        sent.push({ method, params })
+        const tx = params[0]
+        if (tx.to !== multicallAddr) {
+          if (options.failingData?.includes(tx.data)) {
+            throw new Error(`reverted ${tx.data}`)
+          }
+          return tx.data
+        }
+        if (options.aggregateError) throw options.aggregateError
+        if (options.aggregateData) return options.aggregateData
+        const [, calls] = multicallIface.decodeFunctionData(
+          'tryAggregate',
+          tx.data
+        )
+        return multicallIface.encodeFunctionResult('tryAggregate', [
+          calls.map((c: { callData: string }) => [
+            !options.failingData?.includes(c.callData),
+            c.callData,
+          ]),
+        ])
+      }
+    )
+    const provider = new MultiCallBatchProvider(
+      instance(providerMock),
+      multicallAddr,
+      undefined,
+      network
+    )
+    return { provider, sent }
+  }
+
+  const ethCall = (
+    provider: MultiCallBatchProvider,
+    data: string,
+    blockTag = 'latest'
+  ) => provider.send('eth_call', [{ to: targetAddr, data }, blockTag])
+
+  it('coalesces calls into one multicall', async () => {
+    const { provider, sent } = createProviderMock()
+
+    const res = await Promise.all(
+      [1, 2, 3].map(i => ethCall(provider, callData(i)))
+    )
+
+    expect(res).to.deep.eq([callData(1), callData(2), callData(3)])
+    expect(sent.length).to.eq(1)
+    expect(sent[0].params[0].to).to.eq(multicallAddr)
+  })
+
+  it('queues calls per block tag', async () => {
+    const { provider, sent } = createProviderMock()
+
+    const res = await Promise.all([
+      ethCall(provider, callData(1)),
+      ethCall(provider, callData(2), '0x10'),
+      ethCall(provider, callData(3)),
+      ethCall(provider, callData(4), '0x10'),
+    ])
+
+    expect(res).to.deep.eq([
+      callData(1),
+      callData(2),
+      callData(3),
+      callData(4),
+    ])
+    expect(sent.map(s => s.params[1]).sort()).to.deep.eq(['0x10', 'latest'])
+    expect(sent.every(s => s.params[0].to === multicallAddr)).to.be.true
+  })
+
+  it('falls back to individual calls when the aggregate reverts', async () => {
+    const { provider, sent } = createProviderMock({
+      aggregateError: Object.assign(new Error('processing response error'), {
+        error: { code: -32000, message: 'out of gas' },
+      }),
+    })
+
+    const res = await Promise.all(
+      [1, 2].map(i => ethCall(provider, callData(i)))
+    )
+
+    expect(res).to.deep.eq([callData(1), callData(2)])
+    expect(sent.filter(s => s.params[0].to === targetAddr).length).to.eq(2)
+  })
+
+  it('falls back to individual calls when the aggregate does not decode', async () => {
+    // eg. there is no multicall at this block
+    const { provider, sent } = createProviderMock({ aggregateData: '0x' })
+
+    const res = await Promise.all(
+      [1, 2].map(i => ethCall(provider, callData(i)))
+    )
+
+    expect(res).to.deep.eq([callData(1), callData(2)])
+    expect(sent.filter(s => s.params[0].to === targetAddr).length).to.eq(2)
+  })
+
+  it('passes other aggregate errors to all callers', async () => {
+    const timeout = Object.assign(new Error('timeout'), {
+      code: Logger.errors.TIMEOUT,
+    })
+    const { provider, sent } = createProviderMock({ aggregateError: timeout })
+
+    const results = await Promise.allSettled(
+      [1, 2].map(i => ethCall(provider, callData(i)))
+    )
+
+    expect(results).to.deep.eq([
+      { status: 'rejected', reason: timeout },
+      { status: 'rejected', reason: timeout },
+    ])
+    expect(sent.length).to.eq(1)
+  })
+
+  it('resends failed calls so callers receive the original error', async () => {
+    const { provider, sent } = createProviderMock({
+      failingData: [callData(2)],
+    })
+
+    const results = await Promise.allSettled(
+      [1, 2].map(i => ethCall(provider, callData(i)))
+    )
+
+    expect(results[0]).to.deep.eq({ status: 'fulfilled', value: callData(1) })
+    expect(results[1].status).to.eq('rejected')
+    expect((results[1] as PromiseRejectedResult).reason.message).to.eq(
+      `reverted ${callData(2)}`
+    )
+    expect(sent.length).to.eq(2)
+  })
+
+  it('sends calls with other fields as they are', async () => {
+    const { provider, sent } = createProviderMock()
+
+    const res = await provider.send('eth_call', [
+      { to: targetAddr, data: callData(1), from: targetAddr },
+      'latest',
+    ])
+
+    expect(res).to.eq(callData(1))
+    expect(sent.length).to.eq(1)
+    expect(sent[0].params[0].to).to.eq(targetAddr)
+  })
+})
@@ -0,0 +1,195 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { expect } from 'chai'
+import { Provider } from '@ethersproject/abstract-provider'
+
+import { TransactionReceiptWaiter } from '../../src/lib/utils/receiptWaiter'
+
+describe('TransactionReceiptWaiter', () => {
+  // a chain of blocks holding transactions, served by a minimal provider
+  const createChain = () => {
+    const chain = {
+      head: 10,
+      blocks: new Map<number, string[]>(),
+      blockLookups: [] as number[],
+      receiptLookups: [] as string[],
+      listener: undefined as ((blockNumber: number) => void) | undefined,
+    }
+    const blockOf = (txHash: string) =>
+      Array.from(chain.blocks).find(([, txs]) => txs.includes(txHash))?.[0]
+    const provider = {
+      on: (_: string, listener: (blockNumber: number) => void) => {
+        chain.listener = listener
+      },
+      off: () => {
+        chain.listener = undefined
+      },
+      getBlock: async (blockNumber: number) => {
+        chain.blockLookups.push(blockNumber)
+        return {
+          number: blockNumber,
+          transactions: chain.blocks.get(blockNumber) || [],
+        }
+      },
+      getTransactionReceipt: async (txHash: string) => {
+        chain.receiptLookups.push(txHash)
+        const blockNumber = blockOf(txHash)
+        return blockNumber === undefined
+          ? null
+          : {
+              transactionHash: txHash,
+              blockNumber,
+              confirmations: chain.head - blockNumber + 1,
+              status: 1,
+            }
+      },
+    } as unknown as Provider
+
+    const flush = () => new Promise(resolve => setTimeout(resolve, 0))
+    // add a block and report it to the waiter
+    const mine = async (txHashes: string[] = []) => {
+      chain.head++
+      chain.blocks.set(chain.head, txHashes)
+      chain.listener?.(chain.head)
+      await flush()
+    }
+    return { chain, provider, mine, flush }
+  }
+
+  it('resolves transactions that are already mined', async () => {
+    const { chain, provider } = createChain()
+    chain.blocks.set(5, ['0x01'])
+
+    const receipt = await TransactionReceiptWaiter.forProvider(
+      provider
+    ).waitForReceipt('0x01')
+
+    expect(receipt!.blockNumber).to.eq(5)
+    expect(receipt!.confirmations).to.eq(6)
+    expect(chain.listener).to.be.undefined
+  })
+
+  it('only looks up the transactions included in new blocks', async () => {
+    const { chain, provider, mine, flush } = createChain()
+    const waiter = TransactionReceiptWaiter.forProvider(provider)
+    const results = ['0x01', '0x02', '0x03', '0x04'].map(h =>
+      waiter.waitForReceipt(h)
+    )
+    await flush()
+
+    chain.receiptLookups = []
+    await mine()
+    await mine(['0x02'])
+    await mine(['0x01', '0x03', '0x04'])
+
+    expect(chain.blockLookups).to.deep.eq([11, 12, 13])
+    expect(chain.receiptLookups).to.deep.eq(['0x02', '0x01', '0x03', '0x04'])
+    expect((await Promise.all(results)).map(r => r!.blockNumber)).to.deep.eq([
+      13, 12, 13, 13,
+    ])
+    expect(chain.listener).to.be.undefined
+  })
+
+  it('looks up receipts directly when there are fewer transactions than blocks', async () => {
+    const { chain, provider, flush } = createChain()
+    const result = TransactionReceiptWaiter.forProvider(
+      provider
+    ).waitForReceipt('0x01')
+    await flush()
+
+    chain.receiptLookups = []
+    // blocks reported while a check is running are checked together
+    for (let i = 0; i < 3; i++) {
+      chain.head++
+      chain.blocks.set(chain.head, chain.head === 13 ? ['0x01'] : [])
+      chain.listener!(chain.head)
+    }
+    await flush()
+
+    expect(chain.blockLookups).to.deep.eq([])
+    expect((await result)!.blockNumber).to.eq(13)
+    expect(chain.receiptLookups.length).to.be.lessThan(3)
+  })
+
+  it('only fetches a found receipt again once it has enough confirmations', async () => {
+    const { chain, provider, mine } = createChain()
+    chain.blocks.set(10, ['0x01'])
+    let receipt: any
+    TransactionReceiptWaiter.forProvider(provider)
+      .waitForReceipt('0x01', 3)
+      .then(r => (receipt = r))
+
+    await mine()
+    expect(chain.receiptLookups).to.deep.eq(['0x01'])
+    expect(receipt).to.be.undefined
+
+    await mine()
+    expect(chain.receiptLookups).to.deep.eq(['0x01', '0x01'])
+    expect(receipt.confirmations).to.eq(3)
+  })
+
+  it('looks up reorged transactions directly', async () => {
+    const { chain, provider, mine } = createChain()
+    chain.blocks.set(10, ['0x01'])
+    const waiter = TransactionReceiptWaiter.forProvider(provider)
+    let receipt: any
+    waiter.waitForReceipt('0x01', 3).then(r => (receipt = r))
+    // keep more transactions pending than there are new blocks
+    waiter.waitForReceipt('0x02', 1, 1000)
+    waiter.waitForReceipt('0x03', 1, 1000)
+
+    // the transaction is reorged out, and only included again
+    // in a block that has already been checked
+    chain.blocks.set(10, [])
+    await mine()
+    await mine()
+    chain.blocks.set(12, ['0x01'])
+    expect(receipt).to.be.undefined
+
+    chain.blockLookups = []
+    await mine()
+    await mine()
+    expect(chain.blockLookups).to.deep.eq([14])
+    expect(receipt.blockNumber).to.eq(12)
+    expect(receipt.confirmations).to.eq(3)
+  })
+
+  it('resolves null on timeout', async () => {
+    const { chain, provider } = createChain()
+
+    const receipt = await TransactionReceiptWaiter.forProvider(
+      provider
+    ).waitForReceipt('0x01', 1, 10)
+
+    expect(receipt).to.be.null
+    expect(chain.listener).to.be.undefined
+  })
+
+  it('looks up the receipt once without waiting for 0 confirmations', async () => {
+    const { chain, provider } = createChain()
+    chain.blocks.set(5, ['0x01'])
+    const waiter = TransactionReceiptWaiter.forProvider(provider)
+
+    const receipt = await waiter.waitForReceipt('0x01', 0, 60000)
+    expect(receipt!.blockNumber).to.eq(5)
+    expect(await waiter.waitForReceipt('0x02', 0, 60000)).to.be.null
+    expect(chain.receiptLookups).to.deep.eq(['0x01', '0x02'])
+    expect(chain.listener).to.be.undefined
+  })
+})
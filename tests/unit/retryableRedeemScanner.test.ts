@@ -0,0 +1,316 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { expect } from 'chai'
+import { Filter, Log, Provider } from '@ethersproject/abstract-provider'
+import { BigNumber, constants, utils } from 'ethers'
+
+import { ArbRetryableTx__factory } from '../../src/lib/abi/factories/ArbRetryableTx__factory'
+import { ARB_RETRYABLE_TX_ADDRESS } from '../../src/lib/dataEntities/constants'
+import {
+  L1ToL2Message,
+  L1ToL2MessageReader,
+  L1ToL2MessageStatus,
+} from '../../src/lib/message/L1ToL2Message'
+import {
+  RetryableRedeemScanner,
+  RetryableRedeemScannerOptions,
+} from '../../src/lib/message/RetryableRedeemScanner'
+import { HeadTracker } from '../../src/lib/utils/headTracker'
+
+describe('RetryableRedeemScanner', () => {
+  const iFace = ArbRetryableTx__factory.createInterface()
+  const lifetime = 7 * 24 * 60 * 60
+  const timestampOf = (blockNumber: number) => 1000000 + blockNumber * 10
+  const ticket = (i: number) => utils.id(`ticket ${i}`)
+  const retryTx = (i: number) => utils.id(`retry ${i}`)
+
+  // a chain of ArbRetryableTx logs and redeem receipts, served by a minimal provider
+  const createChain = () => {
+    const chain = {
+      head: 100,
+      logs: [] as Log[],
+      receipts: new Map<string, number>(),
+      getLogsRanges: [] as number[][],
+      receiptLookups: [] as string[],
+      failGetLogsFrom: undefined as number | undefined,
+    }
+    const provider = {
+      _isProvider: true,
+      getNetwork: async () => ({ chainId: 42161, name: 'arbitrum' }),
+      getBlockNumber: async () => chain.head,
+      getBlock: async (tag: number | string) => {
+        const number = tag === 'latest' ? chain.head : (tag as number)
+        return {
+          number,
+          hash: utils.hexZeroPad(utils.hexlify(number), 32),
+          timestamp: timestampOf(number),
+        }
+      },
+      getLogs: async (filter: Filter) => {
+        const fromBlock = filter.fromBlock as number
+        const toBlock = filter.toBlock as number
+        chain.getLogsRanges.push([fromBlock, toBlock])
+        if (chain.failGetLogsFrom === fromBlock) throw new Error('unavailable')
+        return chain.logs.filter(
+          l =>
+            l.blockNumber >= fromBlock &&
+            l.blockNumber <= toBlock &&
+            (filter.topics![0] as string[]).includes(l.topics[0])
+        )
+      },
+      getTransactionReceipt: async (txHash: string) => {
+        chain.receiptLookups.push(txHash)
+        const status = chain.receipts.get(txHash)
+        return status === undefined
+          ? null
+          : { transactionHash: txHash, status, blockNumber: 1 }
+      },
+    } as unknown as Provider
+    HeadTracker.forProvider(provider, { maxStalenessMs: 0 })
+
+    const addLog = (blockNumber: number, name: string, args: any[]) => {
+      const { data, topics } = iFace.encodeEventLog(iFace.getEvent(name), args)
+      chain.logs.push({
+        blockNumber,
+        blockHash: utils.hexZeroPad(utils.hexlify(blockNumber), 32),
+        transactionIndex: 0,
+        removed: false,
+        address: ARB_RETRYABLE_TX_ADDRESS,
+        data,
+        topics,
+        transactionHash: utils.id(`tx ${chain.logs.length}`),
+        logIndex: chain.logs.length,
+      })
+    }
+    const create = (blockNumber: number, ticketId: string) =>
+      addLog(blockNumber, 'TicketCreated', [ticketId])
+    const redeem = (
+      blockNumber: number,
+      ticketId: string,
+      retryTxHash: string,
+      status: number | undefined
+    ) => {
+      addLog(blockNumber, 'RedeemScheduled', [
+        ticketId,
+        retryTxHash,
+        0,
+        100000,
+        constants.AddressZero,
+        0,
+        0,
+      ])
+      if (status !== undefined) chain.receipts.set(retryTxHash, status)
+    }
+    const extend = (
+      blockNumber: number,
+      ticketId: string,
+      newTimeout: number
+    ) =>
+      addLog(blockNumber, 'LifetimeExtended', [ticketId, newTimeout])
+    const cancel = (blockNumber: number, ticketId: string) =>
+      addLog(blockNumber, 'Canceled', [ticketId])
+
+    return { chain, provider, create, redeem, extend, cancel }
+  }
+
+  const pageOptions = (
+    pageSize: number,
+    options?: RetryableRedeemScannerOptions
+  ): RetryableRedeemScannerOptions => ({
+    ...options,
+    eventFetcherOptions: {
+      pageSize,
+      maxPageSize: pageSize,
+      concurrency: 1,
+      retries: 0,
+    },
+  })
+
+  it('indexes redeemed, open, cancelled and expired tickets', async () => {
+    const { chain, provider, create, redeem, extend, cancel } = createChain()
+    chain.head = 100
+    create(10, ticket(1))
+    redeem(10, ticket(1), retryTx(1), 1)
+    create(20, ticket(2))
+    redeem(20, ticket(2), retryTx(2), 0)
+    create(30, ticket(3))
+    extend(40, ticket(3), timestampOf(30) + 2 * lifetime)
+    create(50, ticket(4))
+    cancel(60, ticket(4))
+
+    const scanner = new RetryableRedeemScanner(provider, 0)
+    expect(await scanner.sync()).to.eq(100)
+
+    const redeemed = scanner.getTicket(ticket(1))!
+    expect(redeemed.closed).to.be.true
+    expect(redeemed.redeemReceipt!.transactionHash).to.eq(retryTx(1))
+
+    const open = scanner.getTicket(ticket(2))!
+    expect(open.closed).to.be.false
+    expect(open.redeemReceipt).to.be.undefined
+    expect(open.createdBlock).to.eq(20)
+    expect(open.timeout).to.eq(timestampOf(20) + lifetime)
+
+    expect(scanner.getTicket(ticket(3))!.timeout).to.eq(
+      timestampOf(30) + 2 * lifetime
+    )
+    expect(scanner.getTicket(ticket(4))!.closed).to.be.true
+    expect(scanner.getTicket(ticket(5))).to.be.undefined
+
+    // ticket 2 expires once the head passes its timeout
+    chain.head = 20 + lifetime / 10 + 1
+    await scanner.sync()
+    expect(scanner.getTicket(ticket(2))!.closed).to.be.true
+    expect(scanner.getTicket(ticket(3))!.closed).to.be.false
+  })
+
+  it('ignores tickets created before the first block', async () => {
+    const { provider, create, redeem } = createChain()
+    create(10, ticket(1))
+    create(30, ticket(2))
+    redeem(40, ticket(1), retryTx(1), 1)
+
+    const scanner = new RetryableRedeemScanner(provider, 20)
+    await scanner.sync()
+
+    expect(scanner.getTicket(ticket(1))).to.be.undefined
+    expect(scanner.getTicket(ticket(2))).to.not.be.undefined
+  })
+
+  it('syncs in pages and only fetches new blocks', async () => {
+    const { chain, provider } = createChain()
+    chain.head = 35
+    const scanner = new RetryableRedeemScanner(provider, 0, pageOptions(10))
+
+    await scanner.sync()
+    expect(chain.getLogsRanges).to.deep.eq([
+      [0, 9],
+      [10, 19],
+      [20, 29],
+      [30, 35],
+    ])
+    expect(scanner.syncedToBlock).to.eq(35)
+
+    chain.getLogsRanges = []
+    chain.head = 40
+    await scanner.sync()
+    expect(chain.getLogsRanges).to.deep.eq([[36, 40]])
+  })
+
+  it('resumes a failed sync after the last indexed page', async () => {
+    const { chain, provider, create } = createChain()
+    chain.head = 35
+    create(5, ticket(1))
+    create(25, ticket(2))
+    chain.failGetLogsFrom = 20
+    const scanner = new RetryableRedeemScanner(provider, 0, pageOptions(10))
+
+    let error: Error | undefined
+    await scanner.sync().catch(err => (error = err))
+    expect(error!.message).to.eq('unavailable')
+    expect(scanner.syncedToBlock).to.eq(19)
+    expect(scanner.getTicket(ticket(1))).to.not.be.undefined
+
+    chain.failGetLogsFrom = undefined
+    chain.getLogsRanges = []
+    await scanner.sync()
+    expect(chain.getLogsRanges).to.deep.eq([
+      [20, 29],
+      [30, 35],
+    ])
+    expect(scanner.getTicket(ticket(2))).to.not.be.undefined
+  })
+
+  it('looks up missing redeem receipts again on the next sync', async () => {
+    const { chain, provider, create, redeem } = createChain()
+    create(10, ticket(1))
+    redeem(10, ticket(1), retryTx(1), undefined)
+
+    const scanner = new RetryableRedeemScanner(provider, 0)
+    await scanner.sync()
+    expect(scanner.getTicket(ticket(1))).to.be.undefined
+
+    chain.receipts.set(retryTx(1), 1)
+    chain.head = 101
+    await scanner.sync()
+    expect(scanner.getTicket(ticket(1))!.redeemReceipt!.transactionHash).to.eq(
+      retryTx(1)
+    )
+  })
+
+  it('drops the least recently used closed tickets', async () => {
+    const { provider, create, cancel } = createChain()
+    for (let i = 0; i < 3; i++) {
+      create(10 + i, ticket(i))
+      cancel(20 + i, ticket(i))
+    }
+
+    const scanner = new RetryableRedeemScanner(provider, 0, {
+      maxClosedTickets: 2,
+    })
+    await scanner.sync()
+
+    expect(scanner.getTicket(ticket(0))).to.be.undefined
+    expect(scanner.getTicket(ticket(1))!.closed).to.be.true
+    expect(scanner.getTicket(ticket(2))!.closed).to.be.true
+  })
+
+  it('resolves message statuses from the index', async () => {
+    const { chain, provider, create, redeem } = createChain()
+    const message = (i: number) =>
+      L1ToL2Message.fromEventComponents(
+        provider,
+        42161,
+        constants.AddressZero,
+        BigNumber.from(i),
+        BigNumber.from(1000000000),
+        {
+          destAddress: constants.AddressZero,
+          l2CallValue: BigNumber.from(0),
+          l1Value: BigNumber.from(0),
+          maxSubmissionFee: BigNumber.from(0),
+          excessFeeRefundAddress: constants.AddressZero,
+          callValueRefundAddress: constants.AddressZero,
+          gasLimit: BigNumber.from(100000),
+          maxFeePerGas: BigNumber.from(1000000000),
+          data: '0x',
+        }
+      )
+    const redeemed = message(1)
+    const open = message(2)
+    create(10, redeemed.retryableCreationId)
+    redeem(10, redeemed.retryableCreationId, retryTx(1), 1)
+    create(20, open.retryableCreationId)
+    redeem(20, open.retryableCreationId, retryTx(2), 0)
+
+    const scanner = new RetryableRedeemScanner(provider, 0)
+    expect(await redeemed.status(scanner)).to.eq(L1ToL2MessageStatus.REDEEMED)
+    expect(await open.status(scanner)).to.eq(
+      L1ToL2MessageStatus.FUNDS_DEPOSITED_ON_L2
+    )
+    expect(
+      await L1ToL2MessageReader.bulkStatus([redeemed, open], scanner)
+    ).to.deep.eq([
+      L1ToL2MessageStatus.REDEEMED,
+      L1ToL2MessageStatus.FUNDS_DEPOSITED_ON_L2,
+    ])
+    // only the redeems were looked up, while syncing
+    expect(chain.receiptLookups).to.deep.eq([retryTx(1), retryTx(2)])
+  })
+})
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { expect } from 'chai'
+import { Provider } from '@ethersproject/abstract-provider'
+import { BigNumber, utils } from 'ethers'
+
+import { NodeCreatedEvent } from '../../src/lib/abi/RollupUserLogic'
+import {
+  RollupNodeCache,
+  RollupNodeInfo,
+  RollupNodeStatus,
+} from '../../src/lib/message/RollupNodeCache'
+import { FetchedEvent } from '../../src/lib/utils/eventFetcher'
+
+describe('RollupNodeCache', () => {
+  const rollupAddress = '0x5eF0D09d1E6204141B4d37530808eD19f60FBa35'
+
+  const node = (nodeNum: number): RollupNodeInfo => ({
+    nodeNum,
+    createdAtBlock: nodeNum * 10,
+    blockHash: utils.id(`block ${nodeNum}`),
+    sendRoot: utils.id(`send root ${nodeNum}`),
+    sendCount: BigNumber.from(nodeNum * 5),
+    l2BlockNumber: nodeNum * 1000,
+  })
+
+  it('records whether a node was confirmed or rejected', () => {
+    const cache = new RollupNodeCache()
+    cache.set(rollupAddress, node(1), RollupNodeStatus.CONFIRMED)
+    cache.set(rollupAddress, node(2), RollupNodeStatus.REJECTED)
+
+    expect(cache.get(rollupAddress, 1)).to.deep.eq({
+      ...node(1),
+      status: RollupNodeStatus.CONFIRMED,
+    })
+    expect(cache.get(rollupAddress.toLowerCase(), 2)!.status).to.eq(
+      RollupNodeStatus.REJECTED
+    )
+  })
+
+  it('does not cache unresolved nodes', () => {
+    const cache = new RollupNodeCache()
+    cache.set(rollupAddress, node(3), RollupNodeStatus.UNRESOLVED)
+
+    expect(cache.get(rollupAddress, 3)).to.be.undefined
+  })
+
+  it('serves cached nodes without fetching them', async () => {
+    const cache = new RollupNodeCache()
+    cache.set(rollupAddress, node(4), RollupNodeStatus.REJECTED)
+    const log = {
+      event: { nodeNum: BigNumber.from(4) },
+    } as FetchedEvent<NodeCreatedEvent>
+
+    // the l2 provider would throw if the asserted block were looked up
+    const res = await cache.getNodeFromLog(
+      rollupAddress,
+      log,
+      {} as Provider,
+      RollupNodeStatus.UNRESOLVED
+    )
+    expect(res).to.deep.eq(node(4))
+  })
+})
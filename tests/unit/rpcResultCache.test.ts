@@ -0,0 +1,164 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { expect } from 'chai'
+
+import {
+  InMemoryRpcResultCacheStore,
+  RpcResultCache,
+  RpcResultCacheStore,
+} from '../../src/lib/utils/rpcResultCache'
+
+describe('RpcResultCache', () => {
+  const blockHash = '0x' + 'ab'.repeat(32)
+  const txHash = '0x' + 'cd'.repeat(32)
+  const chainId = 42161
+
+  // answers every request with a copy of the result, counting the requests
+  const createSender = (result: any) => {
+    const sent: string[] = []
+    const send = async (method: string) => {
+      sent.push(method)
+      return result && { ...result }
+    }
+    return { sent, send }
+  }
+
+  const receiptAt = (blockNumber: number) => ({
+    transactionHash: txHash,
+    blockNumber: '0x' + blockNumber.toString(16),
+  })
+
+  it('serves blocks by hash from the cache', async () => {
+    const cache = new RpcResultCache()
+    const { sent, send } = createSender({ hash: blockHash, number: '0x1' })
+    const latest = async () => 1
+
+    const first = await cache.send(
+      chainId,
+      'eth_getBlockByHash',
+      [blockHash, false],
+      send,
+      latest
+    )
+    // hashes are case insensitive
+    const second = await cache.send(
+      chainId,
+      'eth_getBlockByHash',
+      [blockHash.toUpperCase().replace('0X', '0x'), false],
+      send,
+      latest
+    )
+
+    expect(second).to.deep.eq(first)
+    expect(sent.length).to.eq(1)
+  })
+
+  it('keeps chains apart', async () => {
+    const cache = new RpcResultCache()
+    const { sent, send } = createSender({ hash: blockHash })
+
+    for (const id of [1, 2, 1]) {
+      await cache.send(id, 'eth_getBlockByHash', [blockHash, false], send, () =>
+        Promise.resolve(1)
+      )
+    }
+
+    expect(sent.length).to.eq(2)
+  })
+
+  it('only caches receipts below the confirmation depth', async () => {
+    const cache = new RpcResultCache(undefined, { receiptConfirmations: 10 })
+    const { sent, send } = createSender(receiptAt(100))
+    let latestBlock = 105
+    const getReceipt = () =>
+      cache.send(chainId, 'eth_getTransactionReceipt', [txHash], send, () =>
+        Promise.resolve(latestBlock)
+      )
+
+    await getReceipt()
+    await getReceipt()
+    expect(sent.length, 'shallow receipts').to.eq(2)
+
+    latestBlock = 110
+    await getReceipt()
+    await getReceipt()
+    expect(sent.length, 'deep receipts').to.eq(3)
+  })
+
+  it('caches receipts straight away with zero confirmations', async () => {
+    const cache = new RpcResultCache(undefined, { receiptConfirmations: 0 })
+    const { sent, send } = createSender(receiptAt(100))
+    const getReceipt = () =>
+      cache.send(chainId, 'eth_getTransactionReceipt', [txHash], send, () =>
+        Promise.resolve(100)
+      )
+
+    await getReceipt()
+    await getReceipt()
+    expect(sent.length).to.eq(1)
+  })
+
+  it('does not cache missing or pending results', async () => {
+    const cache = new RpcResultCache(undefined, { receiptConfirmations: 0 })
+    const missing = createSender(null)
+    const pending = createSender({ transactionHash: txHash, blockNumber: null })
+
+    for (const { send } of [missing, missing, pending, pending]) {
+      await cache.send(
+        chainId,
+        'eth_getTransactionReceipt',
+        [txHash],
+        send,
+        () => Promise.resolve(100)
+      )
+    }
+
+    expect(missing.sent.length).to.eq(2)
+    expect(pending.sent.length).to.eq(2)
+  })
+
+  it('still returns results when the store fails to write', async () => {
+    const store: RpcResultCacheStore = {
+      get: async () => undefined,
+      set: async () => {
+        throw new Error('store unavailable')
+      },
+    }
+    const cache = new RpcResultCache(store)
+    const { send } = createSender({ hash: blockHash })
+
+    expect(
+      await cache.send(chainId, 'eth_getBlockByHash', [blockHash], send, () =>
+        Promise.resolve(1)
+      )
+    ).to.deep.eq({ hash: blockHash })
+  })
+
+  it('evicts the least recently used results from memory', async () => {
+    const store = new InMemoryRpcResultCacheStore(2)
+    await store.set('a', 1)
+    await store.set('b', 2)
+    await store.get('a')
+    await store.set('c', 3)
+
+    expect(await store.get('a')).to.eq(1)
+    expect(await store.get('b')).to.be.undefined
+    expect(await store.get('c')).to.eq(3)
+  })
+})
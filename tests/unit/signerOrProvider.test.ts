@@ -0,0 +1,82 @@
+/*
+ * Copyright 2021, Offchain Labs, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* eslint-env node */
+'use strict'
+
+import { expect } from 'chai'
+import { providers } from 'ethers'
+import { instance, mock, verify, when } from 'ts-mockito'
+
+import { SignerProviderUtils } from '../../src/lib/dataEntities/signerOrProvider'
+
+describe('SignerProviderUtils', () => {
+  // a provider whose chain can be switched under it, like a wallet's
+  const createSwitchingProvider = (anyNetwork = false) => {
+    let chainId = 1
+    const providerMock = mock(providers.JsonRpcProvider)
+    when(providerMock.getNetwork()).thenCall(async () => ({
+      chainId,
+      name: 'test',
+    }))
+    when(providerMock.anyNetwork).thenReturn(anyNetwork)
+    return {
+      providerMock,
+      provider: instance(providerMock),
+      switchChain: (id: number) => (chainId = id),
+    }
+  }
+
+  it('remembers the chain id', async () => {
+    const { providerMock, provider } = createSwitchingProvider()
+
+    const chainIds = await Promise.all([
+      SignerProviderUtils.getChainId(provider),
+      SignerProviderUtils.getChainId(provider),
+    ])
+    expect(chainIds).to.deep.eq([1, 1])
+    expect(await SignerProviderUtils.getChainId(provider)).to.eq(1)
+    verify(providerMock.getNetwork()).once()
+  })
+
+  it('looks up the chain id of any network providers every time', async () => {
+    const { provider, switchChain } = createSwitchingProvider(true)
+
+    expect(await SignerProviderUtils.getChainId(provider)).to.eq(1)
+    switchChain(2)
+    expect(await SignerProviderUtils.getChainId(provider)).to.eq(2)
+  })
+
+  it('checks the network against the current chain id', async () => {
+    const { provider, switchChain } = createSwitchingProvider()
+
+    expect(await SignerProviderUtils.getChainId(provider)).to.eq(1)
+    await SignerProviderUtils.checkNetworkMatches(provider, 1)
+
+    switchChain(2)
+    let err: Error | undefined
+    try {
+      await SignerProviderUtils.checkNetworkMatches(provider, 1)
+    } catch (e) {
+      err = e as Error
+    }
+    expect(err?.message).to.eq(
+      "Signer/provider chain id: 2 doesn't match provided chain id: 1."
+    )
+    // the remembered chain id is refreshed by the check
+    expect(await SignerProviderUtils.getChainId(provider)).to.eq(2)
+    await SignerProviderUtils.checkNetworkMatches(provider, 2)
+  })
+})